@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "Utils/Exceptions.hpp"
+#include "Opengl/Shader.hpp"
+#include "Opengl/Texture.hpp"
+#include "RenderTypes.hpp"
+#include "Sprite.hpp"
+#include "VertexWriter.hpp"
+
+namespace Renderer
+{
+	enum class CommandType
+	{
+		SPRITE, SHAPE
+	};
+
+	struct ShapeCommand
+	{
+		Renderer::Shader* shader;
+		Renderer::Texture* texture;
+		DrawType type;
+		unsigned int vertexOffset;
+		unsigned int vertexCount;
+		unsigned int indexOffset;
+		unsigned int indexCount;
+		bool customIndices;
+	};
+
+	struct DrawCommand
+	{
+		uint64_t key;
+		CommandType type;
+		BlendMode blendMode;
+		unsigned int index;
+	};
+
+	/*
+		draws recorded instead of batched right away. Every command gets a 64 bit sort key:
+		the layer in the top 8 bits, then the state it needs (blend mode, shader, draw type,
+		texture) followed by its submission order. Layers that keep their order put the
+		submission order ahead of the state instead.
+
+		recording makes no GL calls, so a worker thread can fill its own CommandBuffer with
+		drawRect()/drawImage()/drawSprites()/beginShape() and hand it to Render::submit() on
+		the GL thread. The vertices of sprites are made while recording, the GL thread only
+		copies them into its batch and fills in the texture slot. A single CommandBuffer is
+		not safe to record from several threads.
+	*/
+	class CommandBuffer
+	{
+		private:
+			std::vector<DrawCommand> m_commands;
+			std::vector<DrawCommand> m_sortScratch;
+
+			std::vector<Renderer::Sprite> m_sprites;
+			// 4 per sprite, texture slot 0 until they are drawn
+			std::vector<Renderer::DefaultVertex> m_spriteVertices;
+			std::vector<ShapeCommand> m_shapes;
+			std::vector<unsigned char> m_vertices;
+			std::vector<unsigned int> m_indices;
+
+			// compact ids for the sort key, handed out in order of first use
+			std::unordered_map<const void*, unsigned int> m_shaderIds;
+			std::unordered_map<const void*, unsigned int> m_textureIds;
+
+			bool m_orderedLayers[256];
+			unsigned int m_sequence;
+
+			// state of the recording api
+			unsigned char m_layer;
+			BlendMode m_blendMode;
+
+		public:
+			CommandBuffer();
+
+			void setLayerOrdered(unsigned char _layer, bool _ordered) { m_orderedLayers[_layer] = _ordered; };
+			bool isLayerOrdered(unsigned char _layer) const { return m_orderedLayers[_layer]; };
+
+			// recording, the shader and texture of a shape are bound when it is drawn
+			void setLayer(unsigned char _layer) { m_layer = _layer; };
+			void setBlendMode(BlendMode _blendMode) { m_blendMode = _blendMode; };
+
+			void drawRect(int _x, int _y, int _width, int _height, const RectStyle& _style);
+			void drawImage(Renderer::Texture& _texture, int _x, int _y, int _width, int _height, const RectStyle& _style);
+			void drawSprites(const Renderer::Sprite* _sprites, size_t _count);
+			unsigned char* beginShape(Renderer::Shader* _shader, Renderer::Texture* _texture, DrawType _type,
+					unsigned int _vertexCount, unsigned int _indexCount = 0);
+			template<typename Vertex>
+			VertexWriter<Vertex> beginShape(Renderer::Shader* _shader, Renderer::Texture* _texture, DrawType _type,
+					unsigned int _vertexCount, unsigned int _indexCount = 0);
+			void endShape(const unsigned int* _indices);
+
+			void recordSprite(const Renderer::Sprite& _sprite, unsigned char _layer, BlendMode _blendMode);
+			unsigned char* recordShape(Renderer::Shader* _shader, Renderer::Texture* _texture, DrawType _type,
+					unsigned int _vertexCount, unsigned int _indexCount, unsigned char _layer, BlendMode _blendMode);
+			void recordShapeIndices(const unsigned int* _indices, unsigned int _indexCount);
+
+			void append(const CommandBuffer& _commandBuffer);
+			void sort();
+			void clear();
+
+			bool empty() const { return m_commands.empty(); };
+			const std::vector<DrawCommand>& getCommands() const { return m_commands; };
+			const Renderer::Sprite& getSprite(unsigned int _index) const { return m_sprites[_index]; };
+			const Renderer::DefaultVertex* getSpriteVertices(unsigned int _index) const { return m_spriteVertices.data() + 4 * _index; };
+			const ShapeCommand& getShape(unsigned int _index) const { return m_shapes[_index]; };
+			const unsigned char* getVertices(unsigned int _offset) const { return m_vertices.data() + _offset; };
+			const unsigned int* getIndices(unsigned int _offset) const { return m_indices.data() + _offset; };
+
+		private:
+			uint64_t sortKey(unsigned char _layer, BlendMode _blendMode, const Renderer::Shader* _shader,
+					DrawType _type, const Renderer::Texture* _texture);
+
+			static unsigned int compactId(std::unordered_map<const void*, unsigned int>& _ids, const void* _pointer, unsigned int _maxId);
+	};
+
+	template<typename Vertex>
+	VertexWriter<Vertex> CommandBuffer::beginShape(Renderer::Shader* _shader, Renderer::Texture* _texture, DrawType _type,
+			unsigned int _vertexCount, unsigned int _indexCount)
+	{
+		unsigned char* vertices = beginShape(_shader, _texture, _type, _vertexCount, _indexCount);
+
+#ifndef NDEBUG
+		if(_shader->getVertexBitSize() != sizeof(Vertex))
+			throw Renderer::RenderingException("The vertex struct does not match the vertex layout of the shader!");
+#endif
+
+		return VertexWriter<Vertex>(vertices, _vertexCount);
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cmath>
+
+namespace Renderer
+{
+	namespace Math
+	{
+		/*
+			sin and cos at once, within about 1e-7 of std::sin and std::cos for angles within half a
+			turn and slowly less precise further out (about 1e-5 at 100 radians). The angle is
+			reduced to a quarter turn around 0 and both are taken from short polynomials, which
+			is a lot cheaper than two calls into the math library
+		*/
+		inline void FastSinCos(float _angle, float& _sin, float& _cos)
+		{
+			// the quarter turn the angle is closest to, pi / 2 split in two for the subtraction
+			float quadrant = std::floor(_angle * 0.636619772f + 0.5f);
+			float x = _angle - quadrant * 1.5707963705062866f;
+			x += quadrant * 4.371139000186241e-8f;
+
+			float x2 = x * x;
+			float sin_x = x + x * x2 * (-1.6666654611e-1f + x2 * (8.3321608736e-3f + x2 * -1.9515295891e-4f));
+			float cos_x = 1.f - 0.5f * x2 + x2 * x2 * (4.166664568298827e-2f + x2 * (-1.388731625493765e-3f
+					+ x2 * 2.443315711809948e-5f));
+
+			switch(static_cast<int>(quadrant) & 3)
+			{
+				case 0:
+					_sin = sin_x;
+					_cos = cos_x;
+					break;
+				case 1:
+					_sin = cos_x;
+					_cos = -sin_x;
+					break;
+				case 2:
+					_sin = -sin_x;
+					_cos = -cos_x;
+					break;
+				default:
+					_sin = -cos_x;
+					_cos = sin_x;
+					break;
+			}
+		}
+
+		// remembers the sin and cos of the last angle, things drawn one after another often share it
+		class AngleCache
+		{
+			private:
+				float m_angle;
+				float m_sin;
+				float m_cos;
+
+			public:
+				AngleCache()
+					: m_angle(0.f), m_sin(0.f), m_cos(1.f)
+				{}
+
+				void sinCos(float _angle, float& _sin, float& _cos)
+				{
+					if(_angle != m_angle)
+					{
+						m_angle = _angle;
+						m_sin = std::sin(_angle);
+						m_cos = std::cos(_angle);
+					}
+
+					_sin = m_sin;
+					_cos = m_cos;
+				}
+		};
+	}
+}
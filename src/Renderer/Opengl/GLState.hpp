@@ -0,0 +1,89 @@
+#pragma once
+
+#include <unordered_map>
+
+#include <glad/glad.h>
+
+namespace Renderer
+{
+	/*
+		a copy of the GL state of one context. Everything the library binds or enables goes
+		through here so calls that would not change anything are skipped. Deleting a GL object
+		must be reported so a new object reusing its name is not mistaken for it, and code
+		changing the state behind its back must call invalidate()
+	*/
+	class GLState
+	{
+		public:
+			static const unsigned int MAX_TEXTURE_UNITS = 32;
+			static const unsigned int MAX_UNIFORM_BINDINGS = 16;
+
+		private:
+			static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+			GLuint m_program;
+			GLuint m_vertexArray;
+			GLuint m_arrayBuffer;
+			GLuint m_uniformBuffer;
+			GLuint m_uniformBindings[MAX_UNIFORM_BINDINGS];
+
+			// the element buffer binding is part of the vertex array
+			std::unordered_map<GLuint, GLuint> m_elementBuffers;
+
+			unsigned int m_activeTexture;
+			GLuint m_textures[MAX_TEXTURE_UNITS];
+
+			GLenum m_blendSource;
+			GLenum m_blendDestination;
+			GLenum m_blendEquation;
+
+			GLint m_viewport[4];
+			int m_scissorTest;
+			GLint m_scissor[4];
+
+			unsigned int m_skippedCalls;
+			unsigned int m_issuedCalls;
+
+		public:
+			GLState();
+
+			void useProgram(GLuint _program);
+			void bindVertexArray(GLuint _vertexArray);
+			void bindArrayBuffer(GLuint _buffer);
+			void bindElementBuffer(GLuint _buffer);
+			void bindUniformBuffer(GLuint _buffer);
+			void bindUniformBufferBase(unsigned int _binding, GLuint _buffer);
+			void activeTexture(unsigned int _unit);
+			void bindTexture(unsigned int _unit, GLuint _texture);
+
+			void blendFunc(GLenum _source, GLenum _destination);
+			void blendEquation(GLenum _equation);
+			void viewport(GLint _x, GLint _y, GLint _width, GLint _height);
+			void scissorTest(bool _enable);
+			void scissor(GLint _x, GLint _y, GLint _width, GLint _height);
+
+			void programDeleted(GLuint _program);
+			void vertexArrayDeleted(GLuint _vertexArray);
+			void bufferDeleted(GLuint _buffer);
+			void textureDeleted(GLuint _texture);
+			void invalidate();
+
+			GLuint getProgram() const { return m_program; };
+			GLuint getVertexArray() const { return m_vertexArray; };
+			GLuint getArrayBuffer() const { return m_arrayBuffer; };
+			unsigned int getActiveTexture() const { return m_activeTexture; };
+			GLuint getTexture(unsigned int _unit) const { return _unit < MAX_TEXTURE_UNITS ? m_textures[_unit] : UNKNOWN; };
+			const GLint* getViewport() const { return m_viewport; };
+			const GLint* getScissor() const { return m_scissor; };
+			bool isScissorTest() const { return m_scissorTest == 1; };
+
+			// calls left out because the state already matched, and calls passed on to GL
+			unsigned int getSkippedCalls() const { return m_skippedCalls; };
+			unsigned int getIssuedCalls() const { return m_issuedCalls; };
+			void resetCounters() { m_skippedCalls = 0; m_issuedCalls = 0; };
+
+		private:
+			// true when the call has to reach GL
+			bool change(GLuint& _cached, GLuint _value);
+	};
+}
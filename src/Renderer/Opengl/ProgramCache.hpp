@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+namespace Renderer
+{
+	// how the programs of a ProgramCache were made, counted since it was created
+	struct ProgramCacheStats
+	{
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int stores;
+		double loadSeconds;
+		double compileSeconds;
+	};
+
+	/*
+		linked programs saved to a directory with glGetProgramBinary and loaded again with
+		glProgramBinary, so later runs skip compiling. A program is keyed by a hash of its
+		sources and the gl vendor, renderer and version, a binary from another driver is never
+		tried. A binary the driver refuses anyway counts as a miss and the program is compiled
+		like it would be without the cache. Set it with Shader::setProgramCache()
+	*/
+	class ProgramCache
+	{
+		private:
+			std::string m_directory;
+			std::string m_driver;
+			bool m_supported;
+
+			ProgramCacheStats m_stats;
+
+		public:
+			ProgramCache(const std::string& _directory);
+
+			// the key of a program, needs a current context the first time
+			std::string key(const char* _vertexCode, const char* _fragmentCode);
+
+			// false when there was no usable binary, the program is left as it was
+			bool load(const std::string& _key, GLuint _program);
+			void store(const std::string& _key, GLuint _program);
+
+			void addCompileTime(double _seconds) { m_stats.compileSeconds += _seconds; };
+
+			const std::string& getDirectory() const { return m_directory; };
+			const ProgramCacheStats& getStats() const { return m_stats; };
+
+		private:
+			std::string path(const std::string& _key) const;
+
+			static uint64_t hash(uint64_t _hash, const char* _data, size_t _size);
+	};
+}
@@ -1,36 +1,21 @@
 #pragma once
 
 #include <iostream>
-#include <list>
+#include <cstring>
 #include <unordered_map>
+#include <algorithm>
 #include <fstream>
+#include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
 #include "../Window/Window.hpp"
+#include "VertexBuffer.hpp"
+#include "ProgramCache.hpp"
 
 namespace Renderer
 {
-	enum class AttribType
-	{
-		VEC2, VEC3, VEC4,
-		IVEC2, IVEC3, IVEC4,
-		FLOAT, INT
-	};
-
-	enum class AttribDataType
-	{
-		FLOAT, INT
-	};
-
-	struct VBO
-	{
-		GLuint vbo;
-		int size;
-		unsigned int location;
-		AttribDataType type;
-	};
-
 	enum class UniformType
 	{
 		FLOAT, FLOAT_ARR,
@@ -42,26 +27,67 @@ namespace Renderer
 		MAT2, MAT3, MAT4
 	};
 
+	// a uniform and the value it was last set to, uploaded once the shader is bound
 	struct UniformObject
 	{
-		const char* name;
+		std::string name;
 		int location;
 		UniformType type;
+
+		std::vector<unsigned char> value;
+		int count;
+		bool dirty;
 	};
 
+	// a uniform resolved once by Shader::uniform(), only meaningful for the shader it came from
+	struct UniformHandle
+	{
+		int index;
+
+		bool isValid() const { return index >= 0; };
+	};
+
+	// an input of the vertex shader, as the linked program reports it
+	struct ShaderInput
+	{
+		std::string name;
+		unsigned int location;
+		AttribType type;
+	};
+
+	// a uniform block of the linked program and the bytes it takes up
+	struct UniformBlock
+	{
+		std::string name;
+		GLuint index;
+		unsigned int size;
+
+		// set by Shader::uniformBlockBind(), -1 until then
+		int binding;
+	};
+
+	/*
+		after linking, the vertex inputs, uniforms and uniform blocks are read from the program.
+		Every active uniform can be set without a uniformAdd() and found by uniform() with no gl
+		call. vertexAttribsEnable() lays the inputs out by location when no vertexAttribAdd()
+		came before it, and otherwise checks the given layout feeds every input the right kind
+		of value. Inputs and uniforms of types the setters do not cover are left out, as are
+		single array elements. uniformAdd() still finds those through gl
+	*/
 	class Shader
 	{
+		friend class ShaderCompiler;
+		friend class ShaderWatcher;
 		private:
 			static Shader* s_currentShader;
+			static Renderer::ProgramCache* s_programCache;
 
 			GLuint m_program;
 
 			GLuint m_vao;
 			GLuint m_ibo;
 
-			uintptr_t m_attribOffset;
-
-			std::list<VBO> m_vbos;
+			Renderer::VertexBuffer m_vertexBuffer;
 
 			Renderer::Window* m_window;
 
@@ -69,7 +95,25 @@ namespace Renderer
 
 			bool m_autoBind;
 
-			std::unordered_map<const char*, UniformObject> m_uniformLocation;
+			// between submit() and finish(), the driver may still be compiling
+			bool m_pending;
+			bool m_pendingCheckErrs;
+			GLuint m_pendingShaders[2];
+			std::string m_pendingCacheKey;
+			double m_pendingStartTime;
+
+			// uniforms by the order they were added, the names only lead to their index
+			std::vector<UniformObject> m_uniforms;
+			std::unordered_map<std::string, unsigned int> m_uniformIndices;
+			std::vector<unsigned int> m_dirtyUniforms;
+
+			bool m_reflected;
+			std::vector<ShaderInput> m_inputs;
+			std::vector<UniformBlock> m_uniformBlocks;
+
+			// the replacement program while a reload compiles
+			GLuint m_reloadProgram;
+			GLuint m_reloadShaders[2];
 		public:
 			Shader(bool _autoBind = false);
 			~Shader();
@@ -79,15 +123,57 @@ namespace Renderer
 			void createFromFile(const char* _vertexPath, const char* _fragmentPath, bool _checkErrs = false);
 
 			void bind();
+
+			/*
+				swaps in a program built from new sources. Uniform handles stay valid and their values
+				are set again, the vertex layout stays and has to fit the new inputs. On failure the
+				old program stays and the reason is left in _error. See ShaderWatcher to reload
+				without blocking
+			*/
+			bool reload(const char* _vertexCode, const char* _fragmentCode, std::string& _error);
+
+			// one draw that covers no pixels, so the driver does not finish the program on the first real one
+			void warmUp();
 			bool isBound() const { return this == s_currentShader; };
+			// submitted by a ShaderCompiler and not used yet, nothing is reflected until then
+			bool isPending() const { return m_pending; };
 			bool willAutoBind() const { return m_autoBind; };
 
 			void verticesData(const void* _vertices, unsigned int _arrBitSize);
 
 			void indicesData(unsigned int* _indices, unsigned int _indicesCount);
 
-			void uniformAdd(const char* _uniformName, UniformType _type);
-
+			void bindStreamBuffer(GLuint _vertexBuffer, GLuint _indexBuffer, unsigned int _vertexOffset = 0);
+
+			// reads the uniform block from whatever UniformBuffer is bound to _binding
+			bool uniformBlockBind(const char* _blockName, unsigned int _binding);
+
+			UniformHandle uniformAdd(const char* _uniformName, UniformType _type);
+			UniformHandle uniform(const char* _uniformName) const;
+
+			/*
+				the setters keep a copy of the value and work without the shader being bound. The
+				bound shader uploads a changed value right away, any other shader uploads all of its
+				changed values the next time it is bound. Setting the value a uniform already has
+				makes no gl call
+			*/
+
+			// setters by handle, for uniforms updated often
+			void setUniformInt(UniformHandle _uniform, int _data);
+			void setUniformInt(UniformHandle _uniform, int _count, const int* _data);
+			void setUniformIvec2(UniformHandle _uniform, const int* _data);
+			void setUniformIvec3(UniformHandle _uniform, const int* _data);
+			void setUniformIvec4(UniformHandle _uniform, const int* _data);
+			void setUniformFloat(UniformHandle _uniform, float _data);
+			void setUniformFloat(UniformHandle _uniform, int _count, const float* _data);
+			void setUniformVec2(UniformHandle _uniform, const float* _data);
+			void setUniformVec3(UniformHandle _uniform, const float* _data);
+			void setUniformVec4(UniformHandle _uniform, const float* _data);
+			void setUniformMat2(UniformHandle _uniform, const float* _data);
+			void setUniformMat3(UniformHandle _uniform, const float* _data);
+			void setUniformMat4(UniformHandle _uniform, const float* _data);
+
+			// setters by name, the name is looked up on every call
 			void setUniformInt(const char* _name, int _data);
 			void setUniformInt(const char* _name, const int* _data);
 			void setUniformInt(const char* _name, int _count, const int* _data);
@@ -96,23 +182,51 @@ namespace Renderer
 			void setUniformFloat(const char* _name, int _count, const float* _data);
 			void setUniformMatrix(const char* _name, const float* _data);
 
-			void vertexAttribAdd(unsigned int _location, AttribType _attribType);
+			void vertexAttribAdd(unsigned int _location, AttribType _attribType, unsigned int _divisor = 0);
 			void vertexAttribsEnable();
 
 			const Renderer::Window* getWindow() const { return m_window; };
-			const std::list<VBO>& getVBO() const { return m_vbos; };
-			const std::unordered_map<const char*, UniformObject>& getUniforms() const { return m_uniformLocation; };
-			unsigned int getVertexBitSize() const { return static_cast<unsigned int>(m_attribOffset); };
+			const Renderer::VertexBuffer& getVertexBuffer() const { return m_vertexBuffer; };
+			const std::vector<UniformObject>& getUniforms() const { return m_uniforms; };
+			const std::vector<ShaderInput>& getInputs() const { return m_inputs; };
+			const std::vector<UniformBlock>& getUniformBlocks() const { return m_uniformBlocks; };
+			bool isReflected() const { return m_reflected; };
+			unsigned int getVertexBitSize() const { return m_vertexBuffer.getStride(); };
 
 			static Shader* getCurrentShader() { return s_currentShader; };
 
+			// shaders created while a cache is set load and store their programs through it
+			static void setProgramCache(Renderer::ProgramCache* _programCache) { s_programCache = _programCache; };
+			static Renderer::ProgramCache* getProgramCache() { return s_programCache; };
+
 		private:
 			void assertValidRenderer();
 			void assertCurrentContext();
+			void submit(const char* _vertexCode, const char* _fragmentCode, bool _checkErrs);
+			void finish();
+			bool isCompletionKnown(bool _parallel) const;
+			void assertLinked();
+			void reflect();
+			void validateVertexLayout();
+			bool checkVertexLayout(const std::vector<ShaderInput>& _inputs, std::string& _message) const;
+			void submitReload(const char* _vertexCode, const char* _fragmentCode);
+			bool isReloadDone(bool _parallel) const;
+			bool finishReload(std::string& _error);
+			void discardReload();
+			UniformHandle addUniform(const std::string& _name, int _location, UniformType _type);
 			void assertShaderBound(const char* _func);
-
-			GLuint createShader(const char* _sourcecode, GLenum _shaderType, bool _checkErrs);
-			static int getAttribSize(const AttribType& _type);
-			static AttribDataType getAttribDataType(const AttribType& _type);
+			UniformObject* assertUniform(UniformHandle _uniform, UniformType _type);
+			UniformObject* storeUniform(UniformHandle _uniform, UniformType _type, const void* _data, unsigned int _bytes, int _count);
+			void uploadUniforms();
+			void uploadUniform(UniformObject& _uniform);
+
+			static std::string readFile(const char* _path);
+			static void reflectInputs(GLuint _program, std::vector<ShaderInput>& _inputs);
+			static const char* uniformTypeName(UniformType _type);
+			static bool reflectAttribType(GLenum _glType, AttribType& _type);
+			static bool reflectUniformType(GLenum _glType, bool _array, UniformType& _type);
+
+			GLuint createShader(const char* _sourcecode, GLenum _shaderType);
+			void checkShader(GLuint _shader, GLenum _shaderType);
 	};
 }
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "Shader.hpp"
+
+// GL_KHR_parallel_shader_compile and GL_ARB_parallel_shader_compile, not part of 4.1 core
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace Renderer
+{
+	/*
+		creates many shaders without waiting on the driver for each one. add() hands the
+		sources over and returns, the compile and link status is only asked for once a shader
+		is used, by poll() or by wait(). Shaders of one compiler must share a context. With
+		GL_KHR_parallel_shader_compile the driver compiles on its own threads and poll() can
+		tell which programs are done without blocking, without it poll() only finishes shaders
+		once wait() is called
+	*/
+	class ShaderCompiler
+	{
+		private:
+			std::vector<Renderer::Shader*> m_pending;
+			std::vector<Renderer::Shader*> m_finished;
+
+			// -1 until the first add() could ask the context
+			int m_parallel;
+
+		public:
+			ShaderCompiler();
+
+			// the shader must be attached, the sources are copied by the driver before add() returns
+			void add(Renderer::Shader& _shader, const char* _vertexCode, const char* _fragmentCode, bool _checkErrs = false);
+			void addFromFile(Renderer::Shader& _shader, const char* _vertexPath, const char* _fragmentPath,
+					bool _checkErrs = false);
+
+			// finishes the shaders the driver is done with, true once none are left
+			bool poll();
+			void wait();
+
+			// warmUp() on every shader finished so far, the vertex layouts should be enabled first
+			void warmUp();
+
+			unsigned int getPendingCount() const { return m_pending.size(); };
+			bool isParallel() const { return m_parallel == 1; };
+
+			// whether the current context compiles in the background, lets the driver pick the thread count
+			static bool enableParallel();
+	};
+}
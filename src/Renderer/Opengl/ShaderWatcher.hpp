@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "Shader.hpp"
+
+namespace Renderer
+{
+	/*
+		reloads shaders whose source files change, for iterating on them while the program
+		runs. Changes are found with inotify on linux and by the file times everywhere else.
+		update() should be called between frames with the context of the shaders current. A
+		changed shader compiles in the background and is swapped in on a later update(), see
+		Shader::reload(). A shader that fails to compile keeps drawing with its old program
+	*/
+	class ShaderWatcher
+	{
+		private:
+			struct WatchedShader
+			{
+				Renderer::Shader* shader;
+				std::filesystem::path paths[2];
+				std::filesystem::file_time_type writeTimes[2];
+
+				bool changed;
+				bool reloading;
+			};
+
+			std::vector<WatchedShader> m_shaders;
+
+			// inotify and one watch per directory, the files are often replaced rather than written to
+			int m_inotify;
+			std::vector<std::pair<int, std::filesystem::path>> m_directories;
+
+			// -1 until the first update() could ask the context
+			int m_parallel;
+
+			unsigned int m_reloads;
+			unsigned int m_failures;
+			std::string m_lastError;
+
+		public:
+			ShaderWatcher();
+			~ShaderWatcher();
+
+			ShaderWatcher(const ShaderWatcher&) = delete;
+			ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+			// the shader should have been created from these files
+			void watch(Renderer::Shader& _shader, const char* _vertexPath, const char* _fragmentPath);
+			void unwatch(Renderer::Shader& _shader);
+
+			// the number of shaders swapped in by this call
+			unsigned int update();
+
+			unsigned int getReloadCount() const { return m_reloads; };
+			unsigned int getFailureCount() const { return m_failures; };
+			const std::string& getLastError() const { return m_lastError; };
+
+		private:
+			void readEvents();
+			void readWriteTimes();
+			void watchDirectory(const std::filesystem::path& _directory);
+			void submit(WatchedShader& _watched);
+
+			static std::filesystem::file_time_type writeTime(const std::filesystem::path& _path);
+	};
+}
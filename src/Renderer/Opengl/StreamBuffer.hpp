@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "../Utils/Exceptions.hpp"
+#include "GLState.hpp"
+
+namespace Renderer
+{
+	enum class StreamMode
+	{
+		RING, ORPHAN
+	};
+
+	struct StreamStats
+	{
+		unsigned int wraps;
+		unsigned int stalls;
+		unsigned int orphans;
+	};
+
+	/*
+		a large GPU buffer that batches are streamed into back to back. Each write lands
+		after the previous one and is mapped unsynchronized, so the driver never has to
+		reallocate or wait. The buffer is split into regions guarded by fences: before
+		the head enters a region on its next lap, the draws that read from it last lap
+		must be done.
+	*/
+	class StreamBuffer
+	{
+		private:
+			static const unsigned int s_regionCount = 4;
+
+			Renderer::GLState* m_state;
+
+			GLuint m_buffer;
+			unsigned int m_size;
+			unsigned int m_head;
+
+			StreamMode m_mode;
+
+			GLsync m_fences[s_regionCount];
+			bool m_regionsUsed[s_regionCount];
+			unsigned int m_regionsLap[s_regionCount];
+			unsigned int m_lap;
+
+			StreamStats m_stats;
+
+			// staging memory used when the buffer cannot be mapped
+			std::vector<unsigned char> m_fallback;
+			unsigned int m_mappedOffset;
+			unsigned int m_mappedBytes;
+			bool m_mappedFallback;
+
+		public:
+			StreamBuffer(unsigned int _size, StreamMode _mode = StreamMode::RING);
+			~StreamBuffer();
+
+			void create(Renderer::GLState& _state);
+			void resize(unsigned int _size);
+
+			unsigned int reserve(unsigned int _bytes);
+			void* map(unsigned int _offset, unsigned int _bytes);
+			void unmap();
+			void fence();
+
+			GLuint getId() const { return m_buffer; };
+			unsigned int getSize() const { return m_size; };
+			StreamMode getMode() const { return m_mode; };
+			const StreamStats& getStats() const { return m_stats; };
+
+		private:
+			void enterRegion(unsigned int _region);
+			void releaseFence(unsigned int _region);
+	};
+}
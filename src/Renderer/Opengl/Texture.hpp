@@ -59,9 +59,6 @@ namespace Renderer
 	class Texture
 	{
 		private:
-			static unsigned int s_activeSlot;
-			static std::vector<Texture*> s_boundedTextures;
-
 			unsigned int m_channels;
 			unsigned int m_channelSize;
 			
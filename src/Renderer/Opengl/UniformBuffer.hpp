@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "GLState.hpp"
+
+namespace Renderer
+{
+	/*
+		a buffer backing a uniform block. It is bound to a binding point that any number of
+		shaders can read the block from, see Shader::uniformBlockBind(), so a value shared by
+		every shader is uploaded once instead of once per shader
+	*/
+	class UniformBuffer
+	{
+		private:
+			Renderer::GLState* m_state;
+
+			GLuint m_buffer;
+			unsigned int m_size;
+
+		public:
+			UniformBuffer();
+			~UniformBuffer();
+
+			void create(Renderer::GLState& _state, unsigned int _size);
+
+			void data(const void* _data, unsigned int _bytes, unsigned int _offset = 0);
+			void bind(unsigned int _binding);
+
+			GLuint getId() const { return m_buffer; };
+			unsigned int getSize() const { return m_size; };
+	};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#include "GLState.hpp"
+
+namespace Renderer
+{
+	enum class AttribType
+	{
+		VEC2, VEC3, VEC4,
+		IVEC2, IVEC3, IVEC4,
+		FLOAT, INT,
+
+		// compact formats, read as floats by the shader
+		UBYTE4_NORM,	// 4 bytes mapped to 0 to 1, for colors
+		HALF2,			// 2 half floats
+		SHORT2,			// 2 shorts, not normalized
+		USHORT2_NORM	// 2 unsigned shorts mapped to 0 to 1, for texture coordinates
+	};
+
+	enum class AttribDataType
+	{
+		FLOAT, INT,
+		UBYTE_NORM, HALF, SHORT, USHORT_NORM
+	};
+
+	struct VertexAttrib
+	{
+		int size;
+		unsigned int location;
+		AttribDataType type;
+		unsigned int offset;
+		unsigned int divisor;
+	};
+
+	/*
+		one interleaved buffer per vertex layout, every attribute points into it. Attributes
+		with a divisor advance once per instance instead of once per vertex
+	*/
+	class VertexBuffer
+	{
+		private:
+			Renderer::GLState* m_state;
+
+			GLuint m_vbo;
+			GLuint m_source;
+			unsigned int m_sourceOffset;
+
+			unsigned int m_stride;
+
+			std::vector<VertexAttrib> m_attribs;
+
+			bool m_enabled;
+
+		public:
+			VertexBuffer();
+			~VertexBuffer();
+
+			void attribAdd(unsigned int _location, AttribType _attribType, unsigned int _divisor = 0);
+			void enable(Renderer::GLState& _state);
+			void attach(GLuint _buffer, unsigned int _offset = 0);
+
+			void data(const void* _vertices, unsigned int _arrBitSize);
+
+			bool isEnabled() const { return m_enabled; };
+			GLuint getId() const { return m_vbo; };
+			GLuint getSource() const { return m_source; };
+			unsigned int getSourceOffset() const { return m_sourceOffset; };
+			unsigned int getStride() const { return m_stride; };
+			const std::vector<VertexAttrib>& getAttribs() const { return m_attribs; };
+
+			static int getAttribSize(const AttribType& _type);
+			static AttribDataType getAttribDataType(const AttribType& _type);
+			static unsigned int getAttribDataBytes(AttribDataType _type);
+	};
+}
@@ -0,0 +1,246 @@
+#include "GLState.hpp"
+
+namespace Renderer
+{
+	GLState::GLState()
+		: m_program(0), m_vertexArray(0), m_arrayBuffer(0), m_uniformBuffer(0), m_activeTexture(0),
+		m_blendSource(GL_ONE), m_blendDestination(GL_ZERO), m_blendEquation(GL_FUNC_ADD),
+		m_scissorTest(0), m_skippedCalls(0), m_issuedCalls(0)
+	{
+		// the defaults of a new context, except for the rectangles which follow the window
+		for(unsigned int i=0;i<MAX_TEXTURE_UNITS;++i)
+			m_textures[i] = 0;
+		for(unsigned int i=0;i<MAX_UNIFORM_BINDINGS;++i)
+			m_uniformBindings[i] = 0;
+
+		for(int i=0;i<4;++i)
+		{
+			m_viewport[i] = -1;
+			m_scissor[i] = -1;
+		}
+	}
+
+	void GLState::useProgram(GLuint _program)
+	{
+		if(change(m_program, _program))
+			glUseProgram(_program);
+	}
+
+	void GLState::bindVertexArray(GLuint _vertexArray)
+	{
+		if(change(m_vertexArray, _vertexArray))
+			glBindVertexArray(_vertexArray);
+	}
+
+	void GLState::bindArrayBuffer(GLuint _buffer)
+	{
+		if(change(m_arrayBuffer, _buffer))
+			glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+	}
+
+	void GLState::bindElementBuffer(GLuint _buffer)
+	{
+		// nothing is known about the element buffer of an unknown vertex array
+		if(m_vertexArray == UNKNOWN)
+		{
+			++ m_issuedCalls;
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
+			return;
+		}
+
+		GLuint& element_buffer = m_elementBuffers.insert({ m_vertexArray, UNKNOWN }).first->second;
+		if(change(element_buffer, _buffer))
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffer);
+	}
+
+	void GLState::bindUniformBuffer(GLuint _buffer)
+	{
+		if(change(m_uniformBuffer, _buffer))
+			glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	}
+
+	void GLState::bindUniformBufferBase(unsigned int _binding, GLuint _buffer)
+	{
+		// binding to an indexed point binds the generic target as well
+		if(_binding < MAX_UNIFORM_BINDINGS && !change(m_uniformBindings[_binding], _buffer))
+			return;
+
+		if(_binding >= MAX_UNIFORM_BINDINGS)
+			++ m_issuedCalls;
+		m_uniformBuffer = _buffer;
+		glBindBufferBase(GL_UNIFORM_BUFFER, _binding, _buffer);
+	}
+
+	void GLState::activeTexture(unsigned int _unit)
+	{
+		if(change(m_activeTexture, _unit))
+			glActiveTexture(GL_TEXTURE0 + _unit);
+	}
+
+	void GLState::bindTexture(unsigned int _unit, GLuint _texture)
+	{
+		// the unit stays active for whatever edits the texture next
+		activeTexture(_unit);
+
+		// units past the cache are always bound
+		if(_unit >= MAX_TEXTURE_UNITS)
+		{
+			++ m_issuedCalls;
+			glBindTexture(GL_TEXTURE_2D, _texture);
+			return;
+		}
+
+		if(change(m_textures[_unit], _texture))
+			glBindTexture(GL_TEXTURE_2D, _texture);
+	}
+
+	void GLState::blendFunc(GLenum _source, GLenum _destination)
+	{
+		if(m_blendSource == _source && m_blendDestination == _destination)
+		{
+			++ m_skippedCalls;
+			return;
+		}
+
+		++ m_issuedCalls;
+		m_blendSource = _source;
+		m_blendDestination = _destination;
+		glBlendFunc(_source, _destination);
+	}
+
+	void GLState::blendEquation(GLenum _equation)
+	{
+		if(change(m_blendEquation, _equation))
+			glBlendEquation(_equation);
+	}
+
+	void GLState::viewport(GLint _x, GLint _y, GLint _width, GLint _height)
+	{
+		if(m_viewport[0] == _x && m_viewport[1] == _y && m_viewport[2] == _width && m_viewport[3] == _height)
+		{
+			++ m_skippedCalls;
+			return;
+		}
+
+		++ m_issuedCalls;
+		m_viewport[0] = _x;
+		m_viewport[1] = _y;
+		m_viewport[2] = _width;
+		m_viewport[3] = _height;
+		glViewport(_x, _y, _width, _height);
+	}
+
+	void GLState::scissorTest(bool _enable)
+	{
+		if(m_scissorTest == (_enable ? 1 : 0))
+		{
+			++ m_skippedCalls;
+			return;
+		}
+
+		++ m_issuedCalls;
+		m_scissorTest = _enable ? 1 : 0;
+		if(_enable)
+			glEnable(GL_SCISSOR_TEST);
+		else
+			glDisable(GL_SCISSOR_TEST);
+	}
+
+	void GLState::scissor(GLint _x, GLint _y, GLint _width, GLint _height)
+	{
+		if(m_scissor[0] == _x && m_scissor[1] == _y && m_scissor[2] == _width && m_scissor[3] == _height)
+		{
+			++ m_skippedCalls;
+			return;
+		}
+
+		++ m_issuedCalls;
+		m_scissor[0] = _x;
+		m_scissor[1] = _y;
+		m_scissor[2] = _width;
+		m_scissor[3] = _height;
+		glScissor(_x, _y, _width, _height);
+	}
+
+	void GLState::programDeleted(GLuint _program)
+	{
+		// deleting the program in use only takes effect once another one is used
+		if(m_program == _program)
+			m_program = UNKNOWN;
+	}
+
+	void GLState::vertexArrayDeleted(GLuint _vertexArray)
+	{
+		m_elementBuffers.erase(_vertexArray);
+		if(m_vertexArray == _vertexArray)
+			m_vertexArray = 0;
+	}
+
+	void GLState::bufferDeleted(GLuint _buffer)
+	{
+		// deleted buffers are unbound from the context and from the bound vertex array only
+		if(m_arrayBuffer == _buffer)
+			m_arrayBuffer = 0;
+		if(m_uniformBuffer == _buffer)
+			m_uniformBuffer = 0;
+		for(unsigned int i=0;i<MAX_UNIFORM_BINDINGS;++i)
+		{
+			if(m_uniformBindings[i] == _buffer)
+				m_uniformBindings[i] = 0;
+		}
+
+		for(std::pair<const GLuint, GLuint>& element_buffer : m_elementBuffers)
+		{
+			if(element_buffer.second != _buffer)
+				continue;
+
+			element_buffer.second = element_buffer.first == m_vertexArray ? 0 : UNKNOWN;
+		}
+	}
+
+	void GLState::textureDeleted(GLuint _texture)
+	{
+		for(unsigned int i=0;i<MAX_TEXTURE_UNITS;++i)
+		{
+			if(m_textures[i] == _texture)
+				m_textures[i] = 0;
+		}
+	}
+
+	void GLState::invalidate()
+	{
+		m_program = UNKNOWN;
+		m_vertexArray = UNKNOWN;
+		m_arrayBuffer = UNKNOWN;
+		m_uniformBuffer = UNKNOWN;
+		for(unsigned int i=0;i<MAX_UNIFORM_BINDINGS;++i)
+			m_uniformBindings[i] = UNKNOWN;
+		m_elementBuffers.clear();
+		m_activeTexture = UNKNOWN;
+		for(unsigned int i=0;i<MAX_TEXTURE_UNITS;++i)
+			m_textures[i] = UNKNOWN;
+
+		m_blendSource = UNKNOWN;
+		m_blendDestination = UNKNOWN;
+		m_blendEquation = UNKNOWN;
+		m_scissorTest = -1;
+		for(int i=0;i<4;++i)
+		{
+			m_viewport[i] = -1;
+			m_scissor[i] = -1;
+		}
+	}
+
+	bool GLState::change(GLuint& _cached, GLuint _value)
+	{
+		if(_cached == _value)
+		{
+			++ m_skippedCalls;
+			return false;
+		}
+
+		++ m_issuedCalls;
+		_cached = _value;
+		return true;
+	}
+}
@@ -0,0 +1,172 @@
+#include "ProgramCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+#include <GLFW/glfw3.h>
+
+namespace Renderer
+{
+	namespace
+	{
+		// the start of every cache file, bumped when the layout changes
+		const char CACHE_MAGIC[4] = { 'R', 'P', 'B', '1' };
+
+		struct CacheHeader
+		{
+			char magic[4];
+			uint32_t format;
+			uint32_t length;
+		};
+	}
+
+	ProgramCache::ProgramCache(const std::string& _directory)
+		: m_directory(_directory), m_driver(""), m_supported(true), m_stats({ 0, 0, 0, 0.0, 0.0 })
+	{
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+	}
+
+	std::string ProgramCache::key(const char* _vertexCode, const char* _fragmentCode)
+	{
+		// the driver only changes with the context, it is read once
+		if(m_driver.empty())
+		{
+			const GLenum names[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+			for(GLenum name : names)
+			{
+				const GLubyte* value = glGetString(name);
+				m_driver += value ? reinterpret_cast<const char*>(value) : "?";
+				m_driver += '\n';
+			}
+
+			GLint format_count = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+			m_supported = format_count > 0;
+		}
+
+		// the terminating 0s keep "ab" + "c" apart from "a" + "bc"
+		uint64_t key_hash = 14695981039346656037ull;
+		key_hash = hash(key_hash, _vertexCode, strlen(_vertexCode) + 1);
+		key_hash = hash(key_hash, _fragmentCode, strlen(_fragmentCode) + 1);
+		key_hash = hash(key_hash, m_driver.c_str(), m_driver.size());
+
+		char key_string[17];
+		snprintf(key_string, sizeof(key_string), "%016llx", static_cast<unsigned long long>(key_hash));
+		return key_string;
+	}
+
+	bool ProgramCache::load(const std::string& _key, GLuint _program)
+	{
+		if(!m_supported)
+		{
+			++ m_stats.misses;
+			return false;
+		}
+
+		double start_time = glfwGetTime();
+
+		std::ifstream file(path(_key), std::ios::binary);
+		CacheHeader header;
+		if(!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+				|| memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+		{
+			++ m_stats.misses;
+			return false;
+		}
+
+		// a damaged header must not size the allocation, store() writes exactly the binary after it
+		file.seekg(0, std::ios::end);
+		std::streamoff binary_size = static_cast<std::streamoff>(file.tellg()) - static_cast<std::streamoff>(sizeof(header));
+		if(header.length == 0 || binary_size != static_cast<std::streamoff>(header.length))
+		{
+			++ m_stats.misses;
+			return false;
+		}
+
+		file.seekg(sizeof(header), std::ios::beg);
+		std::vector<char> binary(header.length);
+		if(!file.read(binary.data(), binary.size()))
+		{
+			++ m_stats.misses;
+			return false;
+		}
+
+		// the driver may still turn it down, after an update for example
+		glProgramBinary(_program, header.format, binary.data(), header.length);
+
+		GLint success;
+		glGetProgramiv(_program, GL_LINK_STATUS, &success);
+		if(!success)
+		{
+			++ m_stats.misses;
+			return false;
+		}
+
+		++ m_stats.hits;
+		m_stats.loadSeconds += glfwGetTime() - start_time;
+		return true;
+	}
+
+	void ProgramCache::store(const std::string& _key, GLuint _program)
+	{
+		if(!m_supported)
+			return;
+
+		GLint success;
+		glGetProgramiv(_program, GL_LINK_STATUS, &success);
+		if(!success)
+			return;
+
+		GLint length = 0;
+		glGetProgramiv(_program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if(length <= 0)
+			return;
+
+		CacheHeader header;
+		memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+
+		std::vector<char> binary(length);
+		GLenum format;
+		glGetProgramBinary(_program, length, &length, &format, binary.data());
+		header.format = format;
+		header.length = length;
+
+		// written to the side first, a run reading it halfway through would load half a program
+		std::string file_path = path(_key);
+		std::string temp_path = file_path + ".tmp";
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if(!file.is_open())
+			return;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), header.length);
+		file.close();
+		if(!file)
+			return;
+
+		std::error_code error;
+		std::filesystem::rename(temp_path, file_path, error);
+		if(!error)
+			++ m_stats.stores;
+	}
+
+	std::string ProgramCache::path(const std::string& _key) const
+	{
+		return m_directory + "/" + _key + ".bin";
+	}
+
+	uint64_t ProgramCache::hash(uint64_t _hash, const char* _data, size_t _size)
+	{
+		// fnv-1a
+		for(size_t i=0;i<_size;++i)
+		{
+			_hash ^= static_cast<unsigned char>(_data[i]);
+			_hash *= 1099511628211ull;
+		}
+
+		return _hash;
+	}
+}
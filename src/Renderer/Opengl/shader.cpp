@@ -1,12 +1,20 @@
 #include "Shader.hpp"
+#include "ShaderCompiler.hpp"
 
 namespace Renderer
 {
 	Renderer::Shader* Shader::s_currentShader = nullptr;
+	Renderer::ProgramCache* Shader::s_programCache = nullptr;
+
 	Shader::Shader(bool _autoBind)
-		: m_program(0), m_vao(0), m_ibo(0), m_attribOffset(0), m_window(nullptr), m_initialized(false),
-		m_autoBind(_autoBind)
+		: m_program(0), m_vao(0), m_ibo(0), m_window(nullptr), m_initialized(false),
+		m_autoBind(_autoBind), m_pending(false), m_pendingCheckErrs(false), m_pendingStartTime(0.0),
+		m_reflected(false), m_reloadProgram(0)
 	{
+		m_pendingShaders[0] = 0;
+		m_pendingShaders[1] = 0;
+		m_reloadShaders[0] = 0;
+		m_reloadShaders[1] = 0;
 	}
 
 	void Shader::attach(Renderer::Window* _window)
@@ -18,92 +26,332 @@ namespace Renderer
 	}
 
 	void Shader::create(const char* _vertexCode, const char* _fragmentCode, bool _checkErrs)
+	{
+		submit(_vertexCode, _fragmentCode, _checkErrs);
+		finish();
+	}
+
+	void Shader::createFromFile(const char* _vertexPath, const char* _fragmentPath, bool _checkErrs)
+	{
+		std::string vertex_code = readFile(_vertexPath);
+		std::string fragment_code = readFile(_fragmentPath);
+
+		create(vertex_code.c_str(), fragment_code.c_str(), _checkErrs);
+	}
+
+	void Shader::submit(const char* _vertexCode, const char* _fragmentCode, bool _checkErrs)
 	{
 		assertValidRenderer();
 		assertCurrentContext();
 
-		// create the shader program
-		GLuint fragment_shader = createShader(_fragmentCode, GL_FRAGMENT_SHADER, _checkErrs);
-		GLuint vertex_shader = createShader(_vertexCode, GL_VERTEX_SHADER, _checkErrs);
-
 		m_program = glCreateProgram();
-		glAttachShader(m_program, vertex_shader);
-		glAttachShader(m_program, fragment_shader);
+		m_pending = true;
+		m_pendingCheckErrs = _checkErrs;
+		m_pendingShaders[0] = 0;
+		m_pendingShaders[1] = 0;
+
+		// a program linked by an earlier run is loaded instead of compiled
+		m_pendingCacheKey.clear();
+		if(s_programCache)
+		{
+			m_pendingCacheKey = s_programCache->key(_vertexCode, _fragmentCode);
+			if(s_programCache->load(m_pendingCacheKey, m_program))
+			{
+				m_pendingCacheKey.clear();
+				return;
+			}
+		}
+
+		// nothing is asked of the driver here, so it is free to compile in the background
+		m_pendingStartTime = glfwGetTime();
+		m_pendingShaders[0] = createShader(_vertexCode, GL_VERTEX_SHADER);
+		m_pendingShaders[1] = createShader(_fragmentCode, GL_FRAGMENT_SHADER);
+
+		glAttachShader(m_program, m_pendingShaders[0]);
+		glAttachShader(m_program, m_pendingShaders[1]);
+
+		// the binary can only be read back when asked for before linking
+		if(s_programCache)
+			glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 		glLinkProgram(m_program);
+	}
+
+	void Shader::finish()
+	{
+		m_pending = false;
+
+		// loaded from the cache, there is nothing to check
+		if(m_pendingShaders[0] != 0)
+		{
+			GLuint vertex_shader = m_pendingShaders[0];
+			GLuint fragment_shader = m_pendingShaders[1];
+			m_pendingShaders[0] = 0;
+			m_pendingShaders[1] = 0;
+
+			if(m_pendingCheckErrs)
+			{
+				checkShader(fragment_shader, GL_FRAGMENT_SHADER);
+				checkShader(vertex_shader, GL_VERTEX_SHADER);
+			}
+
+			glDetachShader(m_program, vertex_shader);
+			glDetachShader(m_program, fragment_shader);
+			glDeleteShader(vertex_shader);
+			glDeleteShader(fragment_shader);
+
+			if(m_pendingCheckErrs)
+			{
+				GLint success;
+				GLchar message[512];
+
+				glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+				if(!success)
+				{
+					glGetProgramInfoLog(m_program, sizeof(message), nullptr, message);
+					throw Renderer::ShaderCompilationException("Shader program linking failed: " + std::string(message));
+				}
+			}
+
+			if(s_programCache)
+			{
+				s_programCache->store(m_pendingCacheKey, m_program);
+				s_programCache->addCompileTime(glfwGetTime() - m_pendingStartTime);
+			}
+		}
+
+		reflect();
 
 		// create the vao
+		Renderer::GLState& state = m_window->getState();
 		glGenVertexArrays(1, &m_vao);
-		glBindVertexArray(m_vao);
+		state.bindVertexArray(m_vao);
 		
 		glGenBuffers(1, &m_ibo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+		state.bindElementBuffer(m_ibo);
 
 		bind();
 
-		if(!_checkErrs)
+		m_initialized = true;
+	}
+
+	bool Shader::reload(const char* _vertexCode, const char* _fragmentCode, std::string& _error)
+	{
+		submitReload(_vertexCode, _fragmentCode);
+		return finishReload(_error);
+	}
+
+	void Shader::submitReload(const char* _vertexCode, const char* _fragmentCode)
+	{
+		assertValidRenderer();
+		assertCurrentContext();
+		assertLinked();
+
+		// a reload still compiling is replaced by the newer sources
+		discardReload();
+
+		m_reloadShaders[0] = createShader(_vertexCode, GL_VERTEX_SHADER);
+		m_reloadShaders[1] = createShader(_fragmentCode, GL_FRAGMENT_SHADER);
+
+		m_reloadProgram = glCreateProgram();
+		glAttachShader(m_reloadProgram, m_reloadShaders[0]);
+		glAttachShader(m_reloadProgram, m_reloadShaders[1]);
+		glLinkProgram(m_reloadProgram);
+	}
+
+	bool Shader::isReloadDone(bool _parallel) const
+	{
+		if(m_reloadProgram == 0)
+			return true;
+
+		if(!_parallel)
+			return false;
+
+		GLint done = GL_TRUE;
+		glGetProgramiv(m_reloadProgram, GL_COMPLETION_STATUS_KHR, &done);
+		return done == GL_TRUE;
+	}
+
+	bool Shader::finishReload(std::string& _error)
+	{
+		assertValidRenderer();
+		assertCurrentContext();
+
+		if(m_reloadProgram == 0)
+			return false;
+
+		GLuint program = m_reloadProgram;
+		GLuint vertex_shader = m_reloadShaders[0];
+		GLuint fragment_shader = m_reloadShaders[1];
+		m_reloadProgram = 0;
+		m_reloadShaders[0] = 0;
+		m_reloadShaders[1] = 0;
+
+		// any failure leaves the program in use as it was
+		bool success = true;
+		try
 		{
-			glDeleteShader(vertex_shader);
-			glDeleteShader(fragment_shader);
+			checkShader(fragment_shader, GL_FRAGMENT_SHADER);
+			checkShader(vertex_shader, GL_VERTEX_SHADER);
+		}
+		catch(const Renderer::ShaderCompilationException& _exception)
+		{
+			_error = _exception.message;
+			success = false;
+		}
 
-			m_initialized = true;
-			return;
+		glDetachShader(program, vertex_shader);
+		glDetachShader(program, fragment_shader);
+		glDeleteShader(vertex_shader);
+		glDeleteShader(fragment_shader);
+
+		GLint linked = GL_FALSE;
+		if(success)
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+		if(success && !linked)
+		{
+			GLchar message[512];
+			glGetProgramInfoLog(program, sizeof(message), nullptr, message);
+			_error = "Shader program linking failed: " + std::string(message);
+			success = false;
 		}
 
-		GLint success;
-		GLchar message[512];
+		// the vertex array stays as it is, the new program has to read the same layout
+		if(success && m_vertexBuffer.isEnabled())
+		{
+			std::vector<ShaderInput> inputs;
+			reflectInputs(program, inputs);
+			success = checkVertexLayout(inputs, _error);
+		}
 
-		glGetProgramiv(m_program, GL_LINK_STATUS, &success);
 		if(!success)
 		{
-			glGetProgramInfoLog(m_program, sizeof(message), nullptr, message);
-			throw Renderer::ShaderCompilationException("Shader program linking failed: " + std::string(message));
+			glDeleteProgram(program);
+			return false;
 		}
 
-		glDeleteShader(vertex_shader);
-		glDeleteShader(fragment_shader);
+		GLuint previous_program = m_program;
+		m_program = program;
+		reflect();
 
-		m_initialized = true;
+		Renderer::GLState& state = m_window->getState();
+		glDeleteProgram(previous_program);
+		state.programDeleted(previous_program);
+
+		// the new program starts out with default values, everything set so far is sent again
+		for(unsigned int i=0;i<m_uniforms.size();++i)
+		{
+			UniformObject& uniform = m_uniforms[i];
+			if(uniform.value.empty() || uniform.dirty)
+				continue;
+
+			uniform.dirty = true;
+			m_dirtyUniforms.push_back(i);
+		}
+
+		if(isBound())
+		{
+			state.useProgram(m_program);
+			uploadUniforms();
+		}
+
+		return true;
 	}
 
-	void Shader::createFromFile(const char* _vertexPath, const char* _fragmentPath, bool _checkErrs)
+	void Shader::discardReload()
 	{
-		std::string each_line;
-		std::string vertex_code = "";
-		std::string fragment_code = "";
+		if(m_reloadProgram == 0)
+			return;
+
+		glDeleteShader(m_reloadShaders[0]);
+		glDeleteShader(m_reloadShaders[1]);
+		glDeleteProgram(m_reloadProgram);
 
-		// load the vertex shader
-		std::ifstream vertex_file;
-		vertex_file.open(_vertexPath);
-		if(!vertex_file.is_open())
-			throw Renderer::FileNotFoundException("Shader file cannot be opened: " + std::string(_vertexPath) + "!");
+		m_reloadProgram = 0;
+		m_reloadShaders[0] = 0;
+		m_reloadShaders[1] = 0;
+	}
 
-		while(std::getline(vertex_file, each_line))
-			vertex_code += each_line + "\n";
+	void Shader::warmUp()
+	{
+		assertValidRenderer();
+		assertCurrentContext();
+		bind();
 
-		// load the fragment shader
-		std::ifstream fragment_file;
-		fragment_file.open(_fragmentPath);
-		if(!fragment_file.is_open())
-			throw Renderer::FileNotFoundException("Shader file cannot be opened: " + std::string(_fragmentPath) + "!");
+		/*
+			drivers finish some of the program on its first draw, against the state it is drawn
+			with. One triangle of zeroed vertices covers no pixels but gets that done now. The
+			attributes read from a buffer of their own for it, the real one may be empty
+		*/
+		Renderer::GLState& state = m_window->getState();
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		state.bindArrayBuffer(buffer);
 
-		while(std::getline(fragment_file, each_line))
-			fragment_code += each_line + "\n";
+		std::vector<unsigned char> zeros(3 * m_vertexBuffer.getStride() + 4, 0);
+		glBufferData(GL_ARRAY_BUFFER, zeros.size(), zeros.data(), GL_STATIC_DRAW);
 
-		create(vertex_code.c_str(), fragment_code.c_str(), _checkErrs);
+		GLuint source = m_vertexBuffer.getSource();
+		unsigned int source_offset = m_vertexBuffer.getSourceOffset();
+		if(m_vertexBuffer.isEnabled())
+			m_vertexBuffer.attach(buffer);
+
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+
+		if(m_vertexBuffer.isEnabled())
+			m_vertexBuffer.attach(source, source_offset);
+
+		glDeleteBuffers(1, &buffer);
+		state.bufferDeleted(buffer);
+	}
+
+	bool Shader::isCompletionKnown(bool _parallel) const
+	{
+		if(!m_pending)
+			return true;
+
+		// without the extension any query could wait on the driver
+		if(!_parallel)
+			return false;
+
+		GLint done = GL_TRUE;
+		glGetProgramiv(m_program, GL_COMPLETION_STATUS_KHR, &done);
+		return done == GL_TRUE;
+	}
+
+	std::string Shader::readFile(const char* _path)
+	{
+		std::ifstream file;
+		file.open(_path);
+		if(!file.is_open())
+			throw Renderer::FileNotFoundException("Shader file cannot be opened: " + std::string(_path) + "!");
+
+		std::string each_line;
+		std::string code = "";
+		while(std::getline(file, each_line))
+			code += each_line + "\n";
+
+		return code;
 	}
 
 	void Shader::bind()
 	{
 		assertValidRenderer();
 		assertCurrentContext();
+		assertLinked();
 
 		if(isBound())
 			return;
 
-		glUseProgram(m_program);
-		glBindVertexArray(m_vao);
+		Renderer::GLState& state = m_window->getState();
+		state.useProgram(m_program);
+		state.bindVertexArray(m_vao);
 
 		s_currentShader = this;
+
+		// values set while another shader was bound
+		uploadUniforms();
 	}
 
 	void Shader::verticesData(const void* _vertices, unsigned int _arrBitSize)
@@ -112,11 +360,7 @@ namespace Renderer
 		assertCurrentContext();
 		assertShaderBound("verticesData()");
 
-		for(const VBO& each_vbo : m_vbos)
-		{
-			glBindBuffer(GL_ARRAY_BUFFER, each_vbo.vbo);
-			glBufferData(GL_ARRAY_BUFFER, _arrBitSize, _vertices, GL_DYNAMIC_DRAW);
-		}
+		m_vertexBuffer.data(_vertices, _arrBitSize);
 	}
 
 	void Shader::indicesData(unsigned int* _indices, unsigned int _indicesCount)
@@ -125,367 +369,727 @@ namespace Renderer
 		assertCurrentContext();
 		assertShaderBound("indicesData()");
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+		m_window->getState().bindElementBuffer(m_ibo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * _indicesCount, _indices, GL_DYNAMIC_DRAW);
 	}
 
-	GLuint Shader::createShader(const char* _sourcecode, GLenum _shaderType, bool _checkErrs)
+	void Shader::bindStreamBuffer(GLuint _vertexBuffer, GLuint _indexBuffer, unsigned int _vertexOffset)
+	{
+		assertValidRenderer();
+		assertCurrentContext();
+		assertShaderBound("bindStreamBuffer()");
+
+		// source the vertices and indices from buffers owned by someone else
+		m_vertexBuffer.attach(_vertexBuffer, _vertexOffset);
+		m_window->getState().bindElementBuffer(_indexBuffer);
+	}
+
+	bool Shader::uniformBlockBind(const char* _blockName, unsigned int _binding)
+	{
+		assertValidRenderer();
+		assertCurrentContext();
+		assertLinked();
+
+		// blocks the shader does not use are ignored like unknown uniforms
+		GLuint block_index = GL_INVALID_INDEX;
+		if(m_reflected)
+		{
+			for(UniformBlock& block : m_uniformBlocks)
+			{
+				if(block.name != _blockName)
+					continue;
+
+				block_index = block.index;
+				block.binding = _binding;
+			}
+		}
+		else
+			block_index = glGetUniformBlockIndex(m_program, _blockName);
+
+		if(block_index == GL_INVALID_INDEX)
+			return false;
+
+		glUniformBlockBinding(m_program, block_index, _binding);
+		return true;
+	}
+
+	GLuint Shader::createShader(const char* _sourcecode, GLenum _shaderType)
 	{
 		GLuint shader = glCreateShader(_shaderType);
 		glShaderSource(shader, 1, &_sourcecode, nullptr);
 		glCompileShader(shader);
 
-		if(!_checkErrs)
-			return shader;
+		return shader;
+	}
 
+	void Shader::checkShader(GLuint _shader, GLenum _shaderType)
+	{
 		GLint success;
 		GLchar err_msg[512];
-		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-		if(!success)
-		{
-			glGetShaderInfoLog(shader, sizeof(err_msg), nullptr, err_msg);
+		glGetShaderiv(_shader, GL_COMPILE_STATUS, &success);
+		if(success)
+			return;
 
-			std::string shader_type;
-			switch(_shaderType)
-			{
-				case GL_FRAGMENT_SHADER:
-					shader_type = "Fragment Shader";
-					break;
-				case GL_VERTEX_SHADER:
-					shader_type = "Vertex Shader";
-					break;
-				default:
-					shader_type = "Unknown Shader";
-					break;
-			}
+		glGetShaderInfoLog(_shader, sizeof(err_msg), nullptr, err_msg);
 
-			throw Renderer::ShaderCompilationException(shader_type + " failed to compile: " + std::string(err_msg));
-			return 0;
+		std::string shader_type;
+		switch(_shaderType)
+		{
+			case GL_FRAGMENT_SHADER:
+				shader_type = "Fragment Shader";
+				break;
+			case GL_VERTEX_SHADER:
+				shader_type = "Vertex Shader";
+				break;
+			default:
+				shader_type = "Unknown Shader";
+				break;
 		}
 
-		return shader;
+		throw Renderer::ShaderCompilationException(shader_type + " failed to compile: " + std::string(err_msg));
 	}
 
-	void Shader::vertexAttribAdd(unsigned int _location, AttribType _attribType)
+	void Shader::vertexAttribAdd(unsigned int _location, AttribType _attribType, unsigned int _divisor)
 	{
 		assertValidRenderer();
 		assertCurrentContext();
 
 		// vertexAttribAdd() called after vertexAttribsEnable() should be ignored
-		if(m_attribOffset > 0)
-			return;
-
-		int attribute_size = getAttribSize(_attribType);
-		AttribDataType attrib_datatype = getAttribDataType(_attribType);
-		m_vbos.push_back({ 0, attribute_size, _location, attrib_datatype });
+		m_vertexBuffer.attribAdd(_location, _attribType, _divisor);
 	}
 
 	void Shader::vertexAttribsEnable()
 	{
 		assertValidRenderer();
 		assertCurrentContext();
+		assertLinked();
 		assertShaderBound("vertexAttribsEnable()");
 
 		// vertexAttribsEnable() should only be called once
-		if(m_attribOffset > 0)
-			return;
+		if(!m_vertexBuffer.isEnabled())
+			validateVertexLayout();
 
-		unsigned int vertex_size = 0;
-		for(VBO& vbo : m_vbos)
-		{
-			if(vbo.type == AttribDataType::FLOAT)
-				vertex_size += vbo.size * sizeof(float);
-			else if(vbo.type == AttribDataType::INT)
-				vertex_size += vbo.size * sizeof(int);
-		}
-
-		for(VBO& vbo : m_vbos)
-		{
-			glGenBuffers(1, &vbo.vbo);
-			glBindBuffer(GL_ARRAY_BUFFER, vbo.vbo);
-
-			if(vbo.type == AttribDataType::FLOAT)
-			{
-				glVertexAttribPointer(
-					vbo.location,
-					vbo.size,
-					GL_FLOAT,
-					GL_FALSE,
-					vertex_size,
-					(const void*)(m_attribOffset)
-				);
-				m_attribOffset += sizeof(float) * vbo.size;
-			} else if(vbo.type == AttribDataType::INT)
-			{
-				glVertexAttribIPointer(
-					vbo.location,
-					vbo.size,
-					GL_INT,
-					vertex_size,
-					(const void*)(m_attribOffset)
-				);
-				m_attribOffset += sizeof(int) * vbo.size;
-			}
-
-			glEnableVertexAttribArray(vbo.location);
-		}
+		m_vertexBuffer.enable(m_window->getState());
 	}
 
-	void Shader::uniformAdd(const char* _uniformName, UniformType _type)
+	UniformHandle Shader::uniformAdd(const char* _uniformName, UniformType _type)
 	{
 		assertValidRenderer();
 		assertCurrentContext();
+		assertLinked();
 		assertShaderBound("uniformAdd()");
 
-		if(m_uniformLocation.find(_uniformName) != m_uniformLocation.end())
-			return;
+		std::unordered_map<std::string, unsigned int>::iterator it = m_uniformIndices.find(_uniformName);
+		if(it != m_uniformIndices.end())
+			return { static_cast<int>(it->second) };
 
+		// reflection leaves out elements like "u_weights[2]" and types the setters do not cover, gl still knows them
 		int location = glGetUniformLocation(m_program, _uniformName);
+		return addUniform(_uniformName, location, _type);
+	}
 
-		UniformObject uniform_obj = { _uniformName, location, _type };
+	UniformHandle Shader::addUniform(const std::string& _name, int _location, UniformType _type)
+	{
+		m_uniformIndices.insert({ _name, static_cast<unsigned int>(m_uniforms.size()) });
+		m_uniforms.push_back({ _name, _location, _type, {}, 0, false });
 
-		m_uniformLocation.insert({ _uniformName, uniform_obj });
+		return { static_cast<int>(m_uniforms.size()) - 1 };
 	}
 
-	void Shader::setUniformInt(const char* _name, int _data)
+	UniformHandle Shader::uniform(const char* _uniformName) const
 	{
-		assertValidRenderer();
-		assertCurrentContext();
-		assertShaderBound("setUniformInt()");
+		std::unordered_map<std::string, unsigned int>::const_iterator it = m_uniformIndices.find(_uniformName);
+		if(it == m_uniformIndices.end())
+			return { -1 };
 
-		std::unordered_map<const char*, UniformObject>::iterator it = m_uniformLocation.find(_name);
-		if(it == m_uniformLocation.end())
-			return;
-		if(it->second.type != UniformType::INT)
-		{
-			std::string exception_message = "The uniform \"" + std::string(_name) + "\" is not an int! ";
-			exception_message += "Please call the appropriate method!";
-			throw Renderer::InvalidType(exception_message);
-		}
+		return { static_cast<int>(it->second) };
+	}
 
-		glUniform1i(it->second.location, _data);
+	void Shader::setUniformInt(UniformHandle _uniform, int _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::INT, &_data, sizeof(int), 1);
+		if(uniform)
+			glUniform1i(uniform->location, _data);
 	}
 
-	void Shader::setUniformInt(const char* _name, const int* _data)
+	void Shader::setUniformInt(UniformHandle _uniform, int _count, const int* _data)
 	{
-		assertValidRenderer();
-		assertCurrentContext();
-		assertShaderBound("setUniformInt()");
+		UniformObject* uniform = storeUniform(_uniform, UniformType::INT_ARR, _data, sizeof(int) * _count, _count);
+		if(uniform)
+			glUniform1iv(uniform->location, _count, _data);
+	}
+
+	void Shader::setUniformIvec2(UniformHandle _uniform, const int* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::IVEC2, _data, 2 * sizeof(int), 1);
+		if(uniform)
+			glUniform2iv(uniform->location, 1, _data);
+	}
+
+	void Shader::setUniformIvec3(UniformHandle _uniform, const int* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::IVEC3, _data, 3 * sizeof(int), 1);
+		if(uniform)
+			glUniform3iv(uniform->location, 1, _data);
+	}
+
+	void Shader::setUniformIvec4(UniformHandle _uniform, const int* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::IVEC4, _data, 4 * sizeof(int), 1);
+		if(uniform)
+			glUniform4iv(uniform->location, 1, _data);
+	}
+
+	void Shader::setUniformFloat(UniformHandle _uniform, float _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::FLOAT, &_data, sizeof(float), 1);
+		if(uniform)
+			glUniform1f(uniform->location, _data);
+	}
+
+	void Shader::setUniformFloat(UniformHandle _uniform, int _count, const float* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::FLOAT_ARR, _data, sizeof(float) * _count, _count);
+		if(uniform)
+			glUniform1fv(uniform->location, _count, _data);
+	}
+
+	void Shader::setUniformVec2(UniformHandle _uniform, const float* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::VEC2, _data, 2 * sizeof(float), 1);
+		if(uniform)
+			glUniform2fv(uniform->location, 1, _data);
+	}
+
+	void Shader::setUniformVec3(UniformHandle _uniform, const float* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::VEC3, _data, 3 * sizeof(float), 1);
+		if(uniform)
+			glUniform3fv(uniform->location, 1, _data);
+	}
+
+	void Shader::setUniformVec4(UniformHandle _uniform, const float* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::VEC4, _data, 4 * sizeof(float), 1);
+		if(uniform)
+			glUniform4fv(uniform->location, 1, _data);
+	}
+
+	void Shader::setUniformMat2(UniformHandle _uniform, const float* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::MAT2, _data, 4 * sizeof(float), 1);
+		if(uniform)
+			glUniformMatrix2fv(uniform->location, 1, GL_FALSE, _data);
+	}
+
+	void Shader::setUniformMat3(UniformHandle _uniform, const float* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::MAT3, _data, 9 * sizeof(float), 1);
+		if(uniform)
+			glUniformMatrix3fv(uniform->location, 1, GL_FALSE, _data);
+	}
+
+	void Shader::setUniformMat4(UniformHandle _uniform, const float* _data)
+	{
+		UniformObject* uniform = storeUniform(_uniform, UniformType::MAT4, _data, 16 * sizeof(float), 1);
+		if(uniform)
+			glUniformMatrix4fv(uniform->location, 1, GL_FALSE, _data);
+	}
 
-		std::unordered_map<const char*, UniformObject>::iterator it = m_uniformLocation.find(_name);
-		if(it == m_uniformLocation.end())
+	void Shader::setUniformInt(const char* _name, int _data)
+	{
+		setUniformInt(uniform(_name), _data);
+	}
+
+	void Shader::setUniformInt(const char* _name, const int* _data)
+	{
+		// only the name lookup is left to the wrapper, the setter checks the type
+		UniformHandle handle = uniform(_name);
+		if(!handle.isValid())
 			return;
-		if(it->second.type != UniformType::IVEC2 && it->second.type != UniformType::IVEC3 &&
-				it->second.type != UniformType::IVEC4)
-		{
-			std::string exception_message = "The uniform \"" + std::string(_name) + "\" is not an int vector! ";
-			exception_message += "Please call the appropriate method!";
-			throw Renderer::InvalidType(exception_message);
-		}
 
-		switch(it->second.type)
+		switch(m_uniforms[handle.index].type)
 		{
 			case UniformType::IVEC2:
-				glUniform2i(it->second.location, _data[0], _data[1]);
+				setUniformIvec2(handle, _data);
 				break;
 			case UniformType::IVEC3:
-				glUniform3i(it->second.location, _data[0], _data[1], _data[2]);
-				break;
-			case UniformType::IVEC4:
-				glUniform4i(it->second.location, _data[0], _data[1], _data[2], _data[3]);
+				setUniformIvec3(handle, _data);
 				break;
 			default:
+				setUniformIvec4(handle, _data);
 				break;
 		}
 	}
 
 	void Shader::setUniformInt(const char* _name, int _count, const int* _data)
 	{
-		assertValidRenderer();
-		assertCurrentContext();
-		assertShaderBound("setUniformInt()");
+		setUniformInt(uniform(_name), _count, _data);
+	}
 
-		std::unordered_map<const char*, UniformObject>::iterator it = m_uniformLocation.find(_name);
-		if(it == m_uniformLocation.end())
+	void Shader::setUniformFloat(const char* _name, float _data)
+	{
+		setUniformFloat(uniform(_name), _data);
+	}
+
+	void Shader::setUniformFloat(const char* _name, const float* _data)
+	{
+		UniformHandle handle = uniform(_name);
+		if(!handle.isValid())
 			return;
-		if(it->second.type != UniformType::INT_ARR)
+
+		switch(m_uniforms[handle.index].type)
 		{
-			std::string exception_message = "The uniform \"" + std::string(_name) + "\" is not an int array! ";
-			exception_message += "Please call the appropriate method!";
-			throw Renderer::InvalidType(exception_message);
+			case UniformType::VEC2:
+				setUniformVec2(handle, _data);
+				break;
+			case UniformType::VEC3:
+				setUniformVec3(handle, _data);
+				break;
+			default:
+				setUniformVec4(handle, _data);
+				break;
 		}
-
-		glUniform1iv(it->second.location, _count, _data);
 	}
 
-	void Shader::setUniformFloat(const char* _name, float _data)
+	void Shader::setUniformFloat(const char* _name, int _count, const float* _data)
 	{
-		assertValidRenderer();
-		assertCurrentContext();
-		assertShaderBound("setUniformFloat()");
+		setUniformFloat(uniform(_name), _count, _data);
+	}
 
-		std::unordered_map<const char*, UniformObject>::iterator it = m_uniformLocation.find(_name);
-		if(it == m_uniformLocation.end())
+	void Shader::setUniformMatrix(const char* _name, const float* _data)
+	{
+		UniformHandle handle = uniform(_name);
+		if(!handle.isValid())
 			return;
-		if(it->second.type != UniformType::FLOAT)
+
+		switch(m_uniforms[handle.index].type)
 		{
-			std::string exception_message = "The uniform \"" + std::string(_name) + "\" is not a float! ";
-			exception_message += "Please call the appropriate method!";
+			case UniformType::MAT2:
+				setUniformMat2(handle, _data);
+				break;
+			case UniformType::MAT3:
+				setUniformMat3(handle, _data);
+				break;
+			default:
+				setUniformMat4(handle, _data);
+				break;
+		}
+	}
+
+	UniformObject* Shader::assertUniform(UniformHandle _uniform, UniformType _type)
+	{
+		// unknown uniforms are ignored like they are by gl
+		if(_uniform.index < 0 || _uniform.index >= static_cast<int>(m_uniforms.size()))
+			return nullptr;
+
+		UniformObject& uniform = m_uniforms[_uniform.index];
+		if(uniform.type != _type)
+		{
+			std::string exception_message = "The uniform \"" + uniform.name + "\" is a " + uniformTypeName(uniform.type);
+			exception_message += ", not a " + std::string(uniformTypeName(_type)) + "! Please call the appropriate method!";
 			throw Renderer::InvalidType(exception_message);
 		}
 
-		glUniform1f(it->second.location, _data);
+		return &uniform;
 	}
 
-	void Shader::setUniformFloat(const char* _name, const float* _data)
+	UniformObject* Shader::storeUniform(UniformHandle _uniform, UniformType _type, const void* _data, unsigned int _bytes, int _count)
 	{
-		assertValidRenderer();
-		assertCurrentContext();
-		assertShaderBound("setUniformFloat()");
+		if(m_pending)
+		{
+			assertValidRenderer();
+			assertCurrentContext();
+			assertLinked();
+		}
 
-		std::unordered_map<const char*, UniformObject>::iterator it = m_uniformLocation.find(_name);
-		if(it == m_uniformLocation.end())
-			return;
-		if(it->second.type != UniformType::VEC2 && it->second.type != UniformType::VEC3 &&
-				it->second.type != UniformType::VEC4)
+		UniformObject* uniform = assertUniform(_uniform, _type);
+		if(!uniform)
+			return nullptr;
+
+		// setting the value it already has changes nothing
+		const unsigned char* data = static_cast<const unsigned char*>(_data);
+		if(uniform->count == _count && uniform->value.size() == _bytes && memcmp(uniform->value.data(), data, _bytes) == 0)
+			return nullptr;
+
+		uniform->value.assign(data, data + _bytes);
+		uniform->count = _count;
+
+		// the bound shader is drawn with right away, the setter uploads it. Any other one gets it in bind()
+		if(isBound())
 		{
-			std::string exception_message = "The uniform \"" + std::string(_name) + "\" is not a float vector! ";
-			exception_message += "Please call the appropriate method!";
-			throw Renderer::InvalidType(exception_message);
+			assertValidRenderer();
+			assertCurrentContext();
+			return uniform;
+		}
+
+		if(!uniform->dirty)
+		{
+			uniform->dirty = true;
+			m_dirtyUniforms.push_back(_uniform.index);
 		}
 
-		switch(it->second.type)
+		return nullptr;
+	}
+
+	void Shader::uploadUniforms()
+	{
+		for(unsigned int index : m_dirtyUniforms)
+			uploadUniform(m_uniforms[index]);
+
+		m_dirtyUniforms.clear();
+	}
+
+	void Shader::uploadUniform(UniformObject& _uniform)
+	{
+		// only for values held back until bind(), the setters upload to the bound shader themselves
+		const int* int_data = reinterpret_cast<const int*>(_uniform.value.data());
+		const float* float_data = reinterpret_cast<const float*>(_uniform.value.data());
+		switch(_uniform.type)
 		{
+			case UniformType::INT:
+				glUniform1i(_uniform.location, int_data[0]);
+				break;
+			case UniformType::INT_ARR:
+				glUniform1iv(_uniform.location, _uniform.count, int_data);
+				break;
+			case UniformType::IVEC2:
+				glUniform2iv(_uniform.location, 1, int_data);
+				break;
+			case UniformType::IVEC3:
+				glUniform3iv(_uniform.location, 1, int_data);
+				break;
+			case UniformType::IVEC4:
+				glUniform4iv(_uniform.location, 1, int_data);
+				break;
+			case UniformType::FLOAT:
+				glUniform1f(_uniform.location, float_data[0]);
+				break;
+			case UniformType::FLOAT_ARR:
+				glUniform1fv(_uniform.location, _uniform.count, float_data);
+				break;
 			case UniformType::VEC2:
-				glUniform2f(it->second.location, _data[0], _data[1]);
+				glUniform2fv(_uniform.location, 1, float_data);
 				break;
 			case UniformType::VEC3:
-				glUniform3f(it->second.location, _data[0], _data[1], _data[2]);
+				glUniform3fv(_uniform.location, 1, float_data);
 				break;
 			case UniformType::VEC4:
-				glUniform4f(it->second.location, _data[0], _data[1], _data[2], _data[3]);
+				glUniform4fv(_uniform.location, 1, float_data);
 				break;
-			default:
+			case UniformType::MAT2:
+				glUniformMatrix2fv(_uniform.location, 1, GL_FALSE, float_data);
+				break;
+			case UniformType::MAT3:
+				glUniformMatrix3fv(_uniform.location, 1, GL_FALSE, float_data);
+				break;
+			case UniformType::MAT4:
+				glUniformMatrix4fv(_uniform.location, 1, GL_FALSE, float_data);
 				break;
 		}
+
+		_uniform.dirty = false;
 	}
 
-	void Shader::setUniformFloat(const char* _name, int _count, const float* _data)
+	void Shader::reflect()
 	{
-		assertValidRenderer();
-		assertCurrentContext();
-		assertShaderBound("setUniformFloat()");
-
-		std::unordered_map<const char*, UniformObject>::iterator it = m_uniformLocation.find(_name);
-		if(it == m_uniformLocation.end())
+		// a program that failed to link has nothing to report
+		GLint success;
+		glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+		if(!success)
 			return;
-		if(it->second.type != UniformType::FLOAT_ARR)
+
+		GLint max_length = 0;
+		GLint block_length = 0;
+		glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+		glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &block_length);
+		max_length = std::max(max_length, block_length);
+		std::vector<GLchar> name(max_length + 1);
+
+		m_inputs.clear();
+		reflectInputs(m_program, m_inputs);
+
+		// after a reload the uniforms known so far keep their handles, at their new locations
+		for(UniformObject& uniform : m_uniforms)
+			uniform.location = glGetUniformLocation(m_program, uniform.name.c_str());
+
+		// uniforms outside of blocks, arrays are named after their first element
+		GLint uniform_count = 0;
+		glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniform_count);
+		for(GLint i=0;i<uniform_count;++i)
 		{
-			std::string exception_message = "The uniform \"" + std::string(_name) + "\" is not a float array! ";
-			exception_message += "Please call the appropriate method!";
-			throw Renderer::InvalidType(exception_message);
+			GLint size;
+			GLenum gl_type;
+			glGetActiveUniform(m_program, i, name.size(), nullptr, &size, &gl_type, name.data());
+
+			GLuint uniform_index = i;
+			GLint block_index;
+			glGetActiveUniformsiv(m_program, 1, &uniform_index, GL_UNIFORM_BLOCK_INDEX, &block_index);
+			if(block_index != -1)
+				continue;
+
+			std::string uniform_name = name.data();
+			bool array = uniform_name.size() > 3 && uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0;
+			if(array)
+				uniform_name.resize(uniform_name.size() - 3);
+
+			UniformType type;
+			if(uniform_name.compare(0, 3, "gl_") == 0 || !reflectUniformType(gl_type, array, type))
+				continue;
+
+			// a value kept for another type would be uploaded with the wrong call
+			std::unordered_map<std::string, unsigned int>::iterator it = m_uniformIndices.find(uniform_name);
+			if(it != m_uniformIndices.end())
+			{
+				UniformObject& uniform = m_uniforms[it->second];
+				if(uniform.type != type)
+				{
+					uniform.type = type;
+					uniform.value.clear();
+					uniform.count = 0;
+				}
+
+				continue;
+			}
+
+			addUniform(uniform_name, glGetUniformLocation(m_program, uniform_name.c_str()), type);
+		}
+
+		// blocks keep the binding points they were given by name
+		std::vector<UniformBlock> previous_blocks;
+		previous_blocks.swap(m_uniformBlocks);
+
+		GLint block_count = 0;
+		glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_BLOCKS, &block_count);
+		for(GLint i=0;i<block_count;++i)
+		{
+			GLint size = 0;
+			glGetActiveUniformBlockName(m_program, i, name.size(), nullptr, name.data());
+			glGetActiveUniformBlockiv(m_program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+			UniformBlock block = { name.data(), static_cast<GLuint>(i), static_cast<unsigned int>(size), -1 };
+			for(const UniformBlock& previous_block : previous_blocks)
+			{
+				if(previous_block.name == block.name && previous_block.binding >= 0)
+				{
+					block.binding = previous_block.binding;
+					glUniformBlockBinding(m_program, block.index, block.binding);
+				}
+			}
+
+			m_uniformBlocks.push_back(block);
 		}
 
-		glUniform1fv(it->second.location, _count, _data);
+		m_reflected = true;
 	}
 
-	void Shader::setUniformMatrix(const char* _name, const float* _data)
+	void Shader::reflectInputs(GLuint _program, std::vector<ShaderInput>& _inputs)
 	{
-		assertValidRenderer();
-		assertCurrentContext();
-		assertShaderBound("setUniformMatrix()");
+		GLint max_length = 0;
+		glGetProgramiv(_program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+		std::vector<GLchar> name(max_length + 1);
+
+		// vertex inputs, built in ones like gl_VertexID have no location
+		GLint attribute_count = 0;
+		glGetProgramiv(_program, GL_ACTIVE_ATTRIBUTES, &attribute_count);
+		for(GLint i=0;i<attribute_count;++i)
+		{
+			GLint size;
+			GLenum gl_type;
+			glGetActiveAttrib(_program, i, name.size(), nullptr, &size, &gl_type, name.data());
+
+			int location = glGetAttribLocation(_program, name.data());
+			AttribType type;
+			if(location < 0 || !reflectAttribType(gl_type, type))
+				continue;
+
+			_inputs.push_back({ name.data(), static_cast<unsigned int>(location), type });
+		}
+
+		std::sort(_inputs.begin(), _inputs.end(), [](const ShaderInput& _a, const ShaderInput& _b) {
+			return _a.location < _b.location;
+		});
+	}
 
-		std::unordered_map<const char*, UniformObject>::iterator it = m_uniformLocation.find(_name);
-		if(it == m_uniformLocation.end())
+	void Shader::validateVertexLayout()
+	{
+		if(!m_reflected)
 			return;
-		if(it->second.type != UniformType::MAT2 && it->second.type != UniformType::MAT3 &&
-				it->second.type != UniformType::MAT4)
+
+		// with no layout given, the inputs are laid out one after another by location
+		if(m_vertexBuffer.getAttribs().empty())
 		{
-			std::string exception_message = "The uniform \"" + std::string(_name) + "\" is not a matrix! ";
-			exception_message += "Please call the appropriate method!";
-			throw Renderer::InvalidType(exception_message);
+			for(const ShaderInput& input : m_inputs)
+				m_vertexBuffer.attribAdd(input.location, input.type);
+
+			return;
 		}
 
-		switch(it->second.type)
+		std::string message;
+		if(!checkVertexLayout(m_inputs, message))
+			throw Renderer::ShaderOperationRejected(message);
+	}
+
+	bool Shader::checkVertexLayout(const std::vector<ShaderInput>& _inputs, std::string& _message) const
+	{
+		/*
+			an input left out reads a constant and an int read as a float reads garbage, both
+			draw without any gl error. Attributes the program does not use are fine, the
+			compiler may have taken them out
+		*/
+		const std::vector<VertexAttrib>& attribs = m_vertexBuffer.getAttribs();
+		for(const ShaderInput& input : _inputs)
 		{
-			case UniformType::MAT2:
-				glUniformMatrix2fv(it->second.location, 1, GL_FALSE, _data);
-				break;
-			case UniformType::MAT3:
-				glUniformMatrix3fv(it->second.location, 1, GL_FALSE, _data);
-				break;
-			case UniformType::MAT4:
-				glUniformMatrix4fv(it->second.location, 1, GL_FALSE, _data);
-				break;
+			std::vector<VertexAttrib>::const_iterator attrib = std::find_if(attribs.begin(), attribs.end(),
+					[&input](const VertexAttrib& _attrib) { return _attrib.location == input.location; });
+
+			if(attrib == attribs.end())
+			{
+				_message = "The vertex layout has nothing for the input \"" + input.name + "\" at location "
+						+ std::to_string(input.location) + "!";
+				return false;
+			}
+
+			bool integer_input = Renderer::VertexBuffer::getAttribDataType(input.type) == AttribDataType::INT;
+			if(integer_input != (attrib->type == AttribDataType::INT))
+			{
+				_message = "The input \"" + input.name + "\" is read as " + (integer_input ? "an int" : "a float")
+						+ " but the vertex layout gives it " + (integer_input ? "floats" : "ints") + "!";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool Shader::reflectAttribType(GLenum _glType, AttribType& _type)
+	{
+		switch(_glType)
+		{
+			case GL_FLOAT:
+				_type = AttribType::FLOAT;
+				return true;
+			case GL_FLOAT_VEC2:
+				_type = AttribType::VEC2;
+				return true;
+			case GL_FLOAT_VEC3:
+				_type = AttribType::VEC3;
+				return true;
+			case GL_FLOAT_VEC4:
+				_type = AttribType::VEC4;
+				return true;
+			case GL_INT:
+				_type = AttribType::INT;
+				return true;
+			case GL_INT_VEC2:
+				_type = AttribType::IVEC2;
+				return true;
+			case GL_INT_VEC3:
+				_type = AttribType::IVEC3;
+				return true;
+			case GL_INT_VEC4:
+				_type = AttribType::IVEC4;
+				return true;
 			default:
-				break;
+				return false;
 		}
 	}
 
-	int Shader::getAttribSize(const AttribType& _type)
+	bool Shader::reflectUniformType(GLenum _glType, bool _array, UniformType& _type)
 	{
-		switch(_type)
+		switch(_glType)
 		{
-			case AttribType::VEC2:
-				return 2;
-				break;
-			case AttribType::VEC3:
-				return 3;
-				break;
-			case AttribType::VEC4:
-				return 4;
-				break;
-			case AttribType::IVEC2:
-				return 2;
-				break;
-			case AttribType::IVEC3:
-				return 3;
-				break;
-			case AttribType::IVEC4:
-				return 4;
-				break;
-			case AttribType::FLOAT:
-				return 1;
-				break;
-			case AttribType::INT:
-				return 1;
+			// samplers and bools are set as ints
+			case GL_INT:
+			case GL_BOOL:
+			case GL_SAMPLER_1D:
+			case GL_SAMPLER_2D:
+			case GL_SAMPLER_3D:
+			case GL_SAMPLER_CUBE:
+			case GL_SAMPLER_2D_ARRAY:
+			case GL_SAMPLER_BUFFER:
+			case GL_INT_SAMPLER_2D:
+			case GL_UNSIGNED_INT_SAMPLER_2D:
+				_type = _array ? UniformType::INT_ARR : UniformType::INT;
+				return true;
+			case GL_FLOAT:
+				_type = _array ? UniformType::FLOAT_ARR : UniformType::FLOAT;
+				return true;
+			default:
 				break;
 		}
 
-		return 0;
+		// arrays of anything else have no setter
+		if(_array)
+			return false;
+
+		switch(_glType)
+		{
+			case GL_FLOAT_VEC2:
+				_type = UniformType::VEC2;
+				return true;
+			case GL_FLOAT_VEC3:
+				_type = UniformType::VEC3;
+				return true;
+			case GL_FLOAT_VEC4:
+				_type = UniformType::VEC4;
+				return true;
+			case GL_INT_VEC2:
+				_type = UniformType::IVEC2;
+				return true;
+			case GL_INT_VEC3:
+				_type = UniformType::IVEC3;
+				return true;
+			case GL_INT_VEC4:
+				_type = UniformType::IVEC4;
+				return true;
+			case GL_FLOAT_MAT2:
+				_type = UniformType::MAT2;
+				return true;
+			case GL_FLOAT_MAT3:
+				_type = UniformType::MAT3;
+				return true;
+			case GL_FLOAT_MAT4:
+				_type = UniformType::MAT4;
+				return true;
+			default:
+				return false;
+		}
 	}
 
-	AttribDataType Shader::getAttribDataType(const AttribType& _type)
+	const char* Shader::uniformTypeName(UniformType _type)
 	{
 		switch(_type)
 		{
-			case AttribType::VEC2:
-				return AttribDataType::FLOAT;
-				break;
-			case AttribType::VEC3:
-				return AttribDataType::FLOAT;
-				break;
-			case AttribType::VEC4:
-				return AttribDataType::FLOAT;
-				break;
-			case AttribType::IVEC2:
-				return AttribDataType::INT;
-				break;
-			case AttribType::IVEC3:
-				return AttribDataType::INT;
-				break;
-			case AttribType::IVEC4:
-				return AttribDataType::INT;
-				break;
-			case AttribType::FLOAT:
-				return AttribDataType::FLOAT;
-				break;
-			case AttribType::INT:
-				return AttribDataType::INT;
-				break;
+			case UniformType::FLOAT:
+				return "float";
+			case UniformType::FLOAT_ARR:
+				return "float array";
+			case UniformType::VEC2:
+				return "vec2";
+			case UniformType::VEC3:
+				return "vec3";
+			case UniformType::VEC4:
+				return "vec4";
+			case UniformType::INT:
+				return "int";
+			case UniformType::INT_ARR:
+				return "int array";
+			case UniformType::IVEC2:
+				return "ivec2";
+			case UniformType::IVEC3:
+				return "ivec3";
+			case UniformType::IVEC4:
+				return "ivec4";
+			case UniformType::MAT2:
+				return "mat2";
+			case UniformType::MAT3:
+				return "mat3";
+			case UniformType::MAT4:
+				return "mat4";
+			default:
+				return "unknown";
 		}
-
-		return AttribDataType::INT;
 	}
 
 	void Shader::assertValidRenderer()
@@ -510,6 +1114,13 @@ namespace Renderer
 		throw Renderer::InvalidWindowContext("The corresponding window must be made current first!");
 	}
 
+	void Shader::assertLinked()
+	{
+		// a shader submitted by a ShaderCompiler is finished on its first use
+		if(m_pending)
+			finish();
+	}
+
 	void Shader::assertShaderBound(const char* _func)
 	{
 		if(isBound())
@@ -526,22 +1137,34 @@ namespace Renderer
 
 	Shader::~Shader()
 	{
+		discardReload();
+
+		// submitted but never used
+		if(m_pending)
+		{
+			glDeleteShader(m_pendingShaders[0]);
+			glDeleteShader(m_pendingShaders[1]);
+			glDeleteProgram(m_program);
+			m_window->getState().programDeleted(m_program);
+		}
+
 		if(!m_initialized)
 			return;
 
-		// delete all the vbo
-		for(VBO& each_vbo : m_vbos)
-			glDeleteBuffers(1, &each_vbo.vbo);
-
-		m_vbos.clear();
+		if(s_currentShader == this)
+			s_currentShader = nullptr;
 
 		// delete the index buffer
+		Renderer::GLState& state = m_window->getState();
 		glDeleteBuffers(1, &m_ibo);
+		state.bufferDeleted(m_ibo);
 
 		// delete the vao
 		glDeleteVertexArrays(1, &m_vao);
+		state.vertexArrayDeleted(m_vao);
 
 		// delete the shader program
 		glDeleteProgram(m_program);
+		state.programDeleted(m_program);
 	}
 }
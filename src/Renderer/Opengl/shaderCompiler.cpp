@@ -0,0 +1,92 @@
+#include "ShaderCompiler.hpp"
+
+#include <GLFW/glfw3.h>
+
+namespace Renderer
+{
+	ShaderCompiler::ShaderCompiler()
+		: m_parallel(-1)
+	{
+	}
+
+	void ShaderCompiler::add(Renderer::Shader& _shader, const char* _vertexCode, const char* _fragmentCode, bool _checkErrs)
+	{
+		_shader.assertValidRenderer();
+		_shader.assertCurrentContext();
+
+		// the thread count has to be set before the first compile
+		if(m_parallel == -1)
+			m_parallel = enableParallel() ? 1 : 0;
+
+		_shader.submit(_vertexCode, _fragmentCode, _checkErrs);
+		m_pending.push_back(&_shader);
+	}
+
+	void ShaderCompiler::addFromFile(Renderer::Shader& _shader, const char* _vertexPath, const char* _fragmentPath,
+			bool _checkErrs)
+	{
+		std::string vertex_code = Renderer::Shader::readFile(_vertexPath);
+		std::string fragment_code = Renderer::Shader::readFile(_fragmentPath);
+
+		add(_shader, vertex_code.c_str(), fragment_code.c_str(), _checkErrs);
+	}
+
+	bool ShaderCompiler::poll()
+	{
+		// shaders used since they were added are already finished
+		for(size_t i=0;i<m_pending.size();)
+		{
+			Renderer::Shader* shader = m_pending[i];
+			if(!shader->isCompletionKnown(m_parallel == 1))
+			{
+				++ i;
+				continue;
+			}
+
+			m_pending.erase(m_pending.begin() + i);
+			m_finished.push_back(shader);
+			if(shader->isPending())
+				shader->finish();
+		}
+
+		return m_pending.empty();
+	}
+
+	void ShaderCompiler::wait()
+	{
+		// by now every program has had the time the rest of the submits took
+		while(!m_pending.empty())
+		{
+			Renderer::Shader* shader = m_pending.front();
+			m_pending.erase(m_pending.begin());
+			m_finished.push_back(shader);
+
+			if(shader->isPending())
+				shader->finish();
+		}
+	}
+
+	void ShaderCompiler::warmUp()
+	{
+		for(Renderer::Shader* shader : m_finished)
+			shader->warmUp();
+	}
+
+	bool ShaderCompiler::enableParallel()
+	{
+		if(!glfwExtensionSupported("GL_KHR_parallel_shader_compile") && !glfwExtensionSupported("GL_ARB_parallel_shader_compile"))
+			return false;
+
+		// both spell the thread count function differently, the driver picks the count
+		typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint _count);
+		MaxShaderCompilerThreadsProc max_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+				glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+		if(!max_threads)
+			max_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+
+		if(max_threads)
+			max_threads(0xFFFFFFFF);
+
+		return true;
+	}
+}
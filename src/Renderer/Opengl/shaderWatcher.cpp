@@ -0,0 +1,211 @@
+#include "ShaderWatcher.hpp"
+#include "ShaderCompiler.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Renderer
+{
+	ShaderWatcher::ShaderWatcher()
+		: m_inotify(-1), m_parallel(-1), m_reloads(0), m_failures(0), m_lastError("")
+	{
+#ifdef __linux__
+		m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+	}
+
+	void ShaderWatcher::watch(Renderer::Shader& _shader, const char* _vertexPath, const char* _fragmentPath)
+	{
+		WatchedShader watched;
+		watched.shader = &_shader;
+		watched.paths[0] = std::filesystem::absolute(_vertexPath).lexically_normal();
+		watched.paths[1] = std::filesystem::absolute(_fragmentPath).lexically_normal();
+		watched.changed = false;
+		watched.reloading = false;
+
+		for(int i=0;i<2;++i)
+		{
+			watched.writeTimes[i] = writeTime(watched.paths[i]);
+			if(m_inotify >= 0)
+				watchDirectory(watched.paths[i].parent_path());
+		}
+
+		m_shaders.push_back(watched);
+	}
+
+	void ShaderWatcher::unwatch(Renderer::Shader& _shader)
+	{
+		for(const WatchedShader& watched : m_shaders)
+		{
+			if(watched.shader == &_shader && watched.reloading)
+				_shader.discardReload();
+		}
+
+		m_shaders.erase(std::remove_if(m_shaders.begin(), m_shaders.end(),
+				[&_shader](const WatchedShader& _watched) { return _watched.shader == &_shader; }), m_shaders.end());
+	}
+
+	unsigned int ShaderWatcher::update()
+	{
+		if(m_shaders.empty())
+			return 0;
+
+		if(m_parallel == -1)
+			m_parallel = Renderer::ShaderCompiler::enableParallel() ? 1 : 0;
+
+		if(m_inotify >= 0)
+			readEvents();
+		else
+			readWriteTimes();
+
+		/*
+			shaders submitted by an earlier update() are swapped in first. Without the
+			extension there is no asking whether they are done, a frame is the time they get
+		*/
+		unsigned int swapped = 0;
+		for(WatchedShader& watched : m_shaders)
+		{
+			if(!watched.reloading || (m_parallel == 1 && !watched.shader->isReloadDone(true)))
+				continue;
+
+			watched.reloading = false;
+
+			std::string error;
+			if(watched.shader->finishReload(error))
+			{
+				++ m_reloads;
+				++ swapped;
+				continue;
+			}
+
+			++ m_failures;
+			m_lastError = watched.paths[0].filename().string() + " and " + watched.paths[1].filename().string()
+				+ ": " + error;
+		}
+
+		for(WatchedShader& watched : m_shaders)
+		{
+			if(watched.changed)
+				submit(watched);
+		}
+
+		return swapped;
+	}
+
+	void ShaderWatcher::submit(WatchedShader& _watched)
+	{
+		// a file replaced by a rename can be missing for a moment, it is tried again next update()
+		std::string vertex_code;
+		std::string fragment_code;
+		try
+		{
+			vertex_code = Renderer::Shader::readFile(_watched.paths[0].string().c_str());
+			fragment_code = Renderer::Shader::readFile(_watched.paths[1].string().c_str());
+		}
+		catch(const Renderer::FileNotFoundException&)
+		{
+			return;
+		}
+
+		_watched.changed = false;
+		_watched.reloading = true;
+		_watched.shader->submitReload(vertex_code.c_str(), fragment_code.c_str());
+	}
+
+	void ShaderWatcher::readEvents()
+	{
+#ifdef __linux__
+		alignas(struct inotify_event) char buffer[4096];
+		while(true)
+		{
+			ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+			if(length <= 0)
+				break;
+
+			for(char* event_data = buffer;event_data < buffer + length;)
+			{
+				const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(event_data);
+				event_data += sizeof(struct inotify_event) + event->len;
+
+				if(event->len == 0)
+					continue;
+
+				for(const std::pair<int, std::filesystem::path>& directory : m_directories)
+				{
+					if(directory.first != event->wd)
+						continue;
+
+					std::filesystem::path path = directory.second / event->name;
+					for(WatchedShader& watched : m_shaders)
+					{
+						if(watched.paths[0] == path || watched.paths[1] == path)
+							watched.changed = true;
+					}
+				}
+			}
+		}
+#endif
+	}
+
+	void ShaderWatcher::readWriteTimes()
+	{
+		for(WatchedShader& watched : m_shaders)
+		{
+			for(int i=0;i<2;++i)
+			{
+				std::filesystem::file_time_type write_time = writeTime(watched.paths[i]);
+				if(write_time == watched.writeTimes[i])
+					continue;
+
+				watched.writeTimes[i] = write_time;
+				watched.changed = true;
+			}
+		}
+	}
+
+	void ShaderWatcher::watchDirectory(const std::filesystem::path& _directory)
+	{
+#ifdef __linux__
+		for(const std::pair<int, std::filesystem::path>& directory : m_directories)
+		{
+			if(directory.second == _directory)
+				return;
+		}
+
+		// editors that save by writing a new file and renaming it show up as IN_MOVED_TO
+		int watch = inotify_add_watch(m_inotify, _directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if(watch >= 0)
+		{
+			m_directories.push_back({ watch, _directory });
+			return;
+		}
+
+		// the file times still work for a directory inotify cannot watch
+		close(m_inotify);
+		m_inotify = -1;
+		m_directories.clear();
+#endif
+	}
+
+	std::filesystem::file_time_type ShaderWatcher::writeTime(const std::filesystem::path& _path)
+	{
+		std::error_code error;
+		std::filesystem::file_time_type write_time = std::filesystem::last_write_time(_path, error);
+		if(error)
+			return std::filesystem::file_time_type::min();
+
+		return write_time;
+	}
+
+	ShaderWatcher::~ShaderWatcher()
+	{
+#ifdef __linux__
+		if(m_inotify >= 0)
+			close(m_inotify);
+#endif
+	}
+}
@@ -0,0 +1,201 @@
+#include "StreamBuffer.hpp"
+
+namespace Renderer
+{
+	StreamBuffer::StreamBuffer(unsigned int _size, StreamMode _mode)
+		: m_state(nullptr), m_buffer(0), m_size(_size), m_head(0), m_mode(_mode), m_lap(1), m_stats({ 0, 0, 0 }),
+		m_mappedOffset(0), m_mappedBytes(0), m_mappedFallback(false)
+	{
+		for(unsigned int i=0;i<s_regionCount;++i)
+		{
+			m_fences[i] = nullptr;
+			m_regionsUsed[i] = false;
+			m_regionsLap[i] = 0;
+		}
+	}
+
+	void StreamBuffer::create(Renderer::GLState& _state)
+	{
+		if(m_buffer != 0)
+			return;
+
+		m_state = &_state;
+
+		glGenBuffers(1, &m_buffer);
+		m_state->bindArrayBuffer(m_buffer);
+		glBufferData(GL_ARRAY_BUFFER, m_size, nullptr, GL_STREAM_DRAW);
+	}
+
+	void StreamBuffer::resize(unsigned int _size)
+	{
+		m_size = _size;
+		if(m_buffer == 0)
+			return;
+
+		// new storage under the same name, the old one is released once the gpu is done with it
+		for(unsigned int i=0;i<s_regionCount;++i)
+		{
+			releaseFence(i);
+			m_regionsUsed[i] = false;
+			m_regionsLap[i] = 0;
+		}
+		m_head = 0;
+		m_lap = 1;
+
+		m_state->bindArrayBuffer(m_buffer);
+		glBufferData(GL_ARRAY_BUFFER, m_size, nullptr, GL_STREAM_DRAW);
+	}
+
+	unsigned int StreamBuffer::reserve(unsigned int _bytes)
+	{
+		if(_bytes == 0)
+			return m_head;
+
+		if(_bytes > m_size)
+			throw Renderer::RenderingException("The batch is larger than the stream buffer. Consider increasing the stream buffer size!");
+
+		m_state->bindArrayBuffer(m_buffer);
+
+		// orphaning: hand the old storage back to the driver and start over
+		if(m_mode == StreamMode::ORPHAN)
+		{
+			glBufferData(GL_ARRAY_BUFFER, m_size, nullptr, GL_STREAM_DRAW);
+			++ m_stats.orphans;
+			return 0;
+		}
+
+		if(m_head + _bytes > m_size)
+		{
+			m_head = 0;
+			++ m_lap;
+			++ m_stats.wraps;
+		}
+
+		// wait for every region this write is about to overwrite
+		unsigned int region_size = m_size / s_regionCount;
+		unsigned int first_region = m_head / region_size;
+		if(first_region >= s_regionCount)
+			first_region = s_regionCount - 1;
+		unsigned int last_region = (m_head + _bytes - 1) / region_size;
+		if(last_region >= s_regionCount)
+			last_region = s_regionCount - 1;
+
+		for(unsigned int region=first_region;region<=last_region;++region)
+			enterRegion(region);
+
+		unsigned int offset = m_head;
+		m_head += _bytes;
+		return offset;
+	}
+
+	void* StreamBuffer::map(unsigned int _offset, unsigned int _bytes)
+	{
+		m_state->bindArrayBuffer(m_buffer);
+
+		m_mappedOffset = _offset;
+		m_mappedBytes = _bytes;
+		m_mappedFallback = false;
+
+		// the range was either orphaned or fenced in reserve(), so nothing can be reading it
+		GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+		if(m_mode == StreamMode::RING)
+			map_flags |= GL_MAP_UNSYNCHRONIZED_BIT;
+
+		void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, _offset, _bytes, map_flags);
+		if(mapped)
+			return mapped;
+
+		// mapping is not available, write into system memory and orphan from now on
+		m_mode = StreamMode::ORPHAN;
+		m_mappedFallback = true;
+		if(m_fallback.size() < _bytes)
+			m_fallback.resize(_bytes);
+
+		return m_fallback.data();
+	}
+
+	void StreamBuffer::unmap()
+	{
+		m_state->bindArrayBuffer(m_buffer);
+
+		if(m_mappedFallback)
+			glBufferSubData(GL_ARRAY_BUFFER, m_mappedOffset, m_mappedBytes, m_fallback.data());
+		else
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+
+		m_mappedFallback = false;
+	}
+
+	void StreamBuffer::fence()
+	{
+		if(m_mode == StreamMode::ORPHAN)
+			return;
+
+		// one fence covers every region written since the last draw
+		GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		for(unsigned int i=0;i<s_regionCount;++i)
+		{
+			if(!m_regionsUsed[i])
+				continue;
+
+			releaseFence(i);
+			m_fences[i] = sync;
+			m_regionsUsed[i] = false;
+		}
+	}
+
+	void StreamBuffer::enterRegion(unsigned int _region)
+	{
+		m_regionsUsed[_region] = true;
+
+		// only the first write of a lap has to wait for the previous lap
+		if(m_regionsLap[_region] == m_lap)
+			return;
+
+		m_regionsLap[_region] = m_lap;
+		if(!m_fences[_region])
+			return;
+
+		GLenum result = glClientWaitSync(m_fences[_region], 0, 0);
+		if(result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		{
+			++ m_stats.stalls;
+			do
+			{
+				result = glClientWaitSync(m_fences[_region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			} while(result == GL_TIMEOUT_EXPIRED);
+		}
+
+		releaseFence(_region);
+	}
+
+	void StreamBuffer::releaseFence(unsigned int _region)
+	{
+		GLsync sync = m_fences[_region];
+		if(!sync)
+			return;
+
+		m_fences[_region] = nullptr;
+
+		// fences are shared between regions, only delete the last reference
+		for(unsigned int i=0;i<s_regionCount;++i)
+		{
+			if(m_fences[i] == sync)
+				return;
+		}
+
+		glDeleteSync(sync);
+	}
+
+	StreamBuffer::~StreamBuffer()
+	{
+		if(m_buffer == 0)
+			return;
+
+		for(unsigned int i=0;i<s_regionCount;++i)
+			releaseFence(i);
+
+		glDeleteBuffers(1, &m_buffer);
+		m_state->bufferDeleted(m_buffer);
+	}
+}
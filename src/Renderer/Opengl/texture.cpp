@@ -2,8 +2,6 @@
 
 namespace Renderer
 {
-	unsigned int Texture::s_activeSlot = 0;
-	std::vector<Texture*> Texture::s_boundedTextures;
 	Texture::Texture(unsigned int _channelSize, bool _autoBind)
 		: m_channelSize(_channelSize), m_data(nullptr), m_channels(0), m_width(0), m_height(0), m_textureId(0),
 		m_validImage(false), m_textureWrapS(GL_CLAMP_TO_EDGE), m_textureWrapT(GL_CLAMP_TO_EDGE),
@@ -204,23 +202,15 @@ namespace Renderer
 	{
 		assertCurrentContext();
 
-		if(s_activeSlot != _slot)
-			glActiveTexture(GL_TEXTURE0 + _slot);
-		s_activeSlot = _slot;
-
-		glBindTexture(GL_TEXTURE_2D, m_textureId);
-
-		// ensure there are enough space in the std::vector
-		while(s_boundedTextures.size() <= _slot)
-			s_boundedTextures.push_back(nullptr);
-
-		s_boundedTextures.at(_slot) = this;
+		m_window->getState().bindTexture(_slot, m_textureId);
 	}
 
 	bool Texture::isBound(unsigned int _slot) const
 	{
-		if(s_boundedTextures.size() <= _slot) return false;
-		return s_boundedTextures.at(_slot) == this;
+		if(!m_window || m_textureId == 0)
+			return false;
+
+		return m_window->getState().getTexture(_slot) == m_textureId;
 	}
 
 	void Texture::setTextureWrap(GLenum _wrapX, GLenum _wrapY)
@@ -343,15 +333,17 @@ namespace Renderer
 
 	void Texture::assertBound(const char* _func)
 	{
-		if(s_boundedTextures.size() <= s_activeSlot)
-			throw Renderer::TextureOperationRejected("Texture must be bound before using ." + std::string(_func) + "!");
+		// an unknown active unit counts as unit 0
+		unsigned int active_slot = m_window ? m_window->getState().getActiveTexture() : 0;
+		if(active_slot >= GLState::MAX_TEXTURE_UNITS)
+			active_slot = 0;
 
-		if(s_boundedTextures.at(s_activeSlot) == this)
+		if(isBound(active_slot))
 			return;
 
 		if(m_autobind)
 		{
-			bind(s_activeSlot);
+			bind(active_slot);
 			return;
 		}
 
@@ -378,6 +370,7 @@ namespace Renderer
 			return;
 
 		glDeleteTextures(1, &m_textureId);
+		m_window->getState().textureDeleted(m_textureId);
 
 		if(m_fromFile)
 			stbi_image_free(m_data);
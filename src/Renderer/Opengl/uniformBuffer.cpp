@@ -0,0 +1,42 @@
+#include "UniformBuffer.hpp"
+
+namespace Renderer
+{
+	UniformBuffer::UniformBuffer()
+		: m_state(nullptr), m_buffer(0), m_size(0)
+	{
+	}
+
+	void UniformBuffer::create(Renderer::GLState& _state, unsigned int _size)
+	{
+		if(m_buffer != 0)
+			return;
+
+		m_state = &_state;
+		m_size = _size;
+
+		glGenBuffers(1, &m_buffer);
+		m_state->bindUniformBuffer(m_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, m_size, nullptr, GL_DYNAMIC_DRAW);
+	}
+
+	void UniformBuffer::data(const void* _data, unsigned int _bytes, unsigned int _offset)
+	{
+		m_state->bindUniformBuffer(m_buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, _offset, _bytes, _data);
+	}
+
+	void UniformBuffer::bind(unsigned int _binding)
+	{
+		m_state->bindUniformBufferBase(_binding, m_buffer);
+	}
+
+	UniformBuffer::~UniformBuffer()
+	{
+		if(m_buffer == 0)
+			return;
+
+		glDeleteBuffers(1, &m_buffer);
+		m_state->bufferDeleted(m_buffer);
+	}
+}
@@ -0,0 +1,211 @@
+#include "VertexBuffer.hpp"
+
+namespace Renderer
+{
+	VertexBuffer::VertexBuffer()
+		: m_state(nullptr), m_vbo(0), m_source(0), m_sourceOffset(0), m_stride(0), m_enabled(false)
+	{
+	}
+
+	void VertexBuffer::attribAdd(unsigned int _location, AttribType _attribType, unsigned int _divisor)
+	{
+		// the layout is fixed once the attributes are enabled
+		if(m_enabled)
+			return;
+
+		int attribute_size = getAttribSize(_attribType);
+		AttribDataType attrib_datatype = getAttribDataType(_attribType);
+		m_attribs.push_back({ attribute_size, _location, attrib_datatype, 0, _divisor });
+	}
+
+	void VertexBuffer::enable(Renderer::GLState& _state)
+	{
+		// enable() should only be called once
+		if(m_enabled)
+			return;
+
+		m_state = &_state;
+
+		// lay the attributes out one after another in a single vertex
+		for(VertexAttrib& attrib : m_attribs)
+		{
+			attrib.offset = m_stride;
+			m_stride += attrib.size * getAttribDataBytes(attrib.type);
+		}
+
+		// keep every vertex 4 byte aligned, the compact formats can leave it short
+		m_stride = (m_stride + 3) / 4 * 4;
+
+		glGenBuffers(1, &m_vbo);
+		attach(m_vbo);
+
+		for(const VertexAttrib& attrib : m_attribs)
+		{
+			glEnableVertexAttribArray(attrib.location);
+			if(attrib.divisor > 0)
+				glVertexAttribDivisor(attrib.location, attrib.divisor);
+		}
+
+		m_enabled = true;
+	}
+
+	void VertexBuffer::attach(GLuint _buffer, unsigned int _offset)
+	{
+		// the attribute pointers capture the buffer bound when they are set
+		if(m_source == _buffer && m_sourceOffset == _offset)
+			return;
+
+		m_state->bindArrayBuffer(_buffer);
+
+		for(const VertexAttrib& attrib : m_attribs)
+		{
+			const void* attrib_offset = (const void*)(uintptr_t)(_offset + attrib.offset);
+			switch(attrib.type)
+			{
+				case AttribDataType::FLOAT:
+					glVertexAttribPointer(attrib.location, attrib.size, GL_FLOAT, GL_FALSE, m_stride, attrib_offset);
+					break;
+				case AttribDataType::INT:
+					glVertexAttribIPointer(attrib.location, attrib.size, GL_INT, m_stride, attrib_offset);
+					break;
+				case AttribDataType::UBYTE_NORM:
+					glVertexAttribPointer(attrib.location, attrib.size, GL_UNSIGNED_BYTE, GL_TRUE, m_stride, attrib_offset);
+					break;
+				case AttribDataType::HALF:
+					glVertexAttribPointer(attrib.location, attrib.size, GL_HALF_FLOAT, GL_FALSE, m_stride, attrib_offset);
+					break;
+				case AttribDataType::SHORT:
+					glVertexAttribPointer(attrib.location, attrib.size, GL_SHORT, GL_FALSE, m_stride, attrib_offset);
+					break;
+				case AttribDataType::USHORT_NORM:
+					glVertexAttribPointer(attrib.location, attrib.size, GL_UNSIGNED_SHORT, GL_TRUE, m_stride, attrib_offset);
+					break;
+			}
+		}
+
+		m_source = _buffer;
+		m_sourceOffset = _offset;
+	}
+
+	void VertexBuffer::data(const void* _vertices, unsigned int _arrBitSize)
+	{
+		attach(m_vbo);
+
+		m_state->bindArrayBuffer(m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, _arrBitSize, _vertices, GL_DYNAMIC_DRAW);
+	}
+
+	int VertexBuffer::getAttribSize(const AttribType& _type)
+	{
+		switch(_type)
+		{
+			case AttribType::VEC2:
+				return 2;
+				break;
+			case AttribType::VEC3:
+				return 3;
+				break;
+			case AttribType::VEC4:
+				return 4;
+				break;
+			case AttribType::IVEC2:
+				return 2;
+				break;
+			case AttribType::IVEC3:
+				return 3;
+				break;
+			case AttribType::IVEC4:
+				return 4;
+				break;
+			case AttribType::FLOAT:
+				return 1;
+				break;
+			case AttribType::INT:
+				return 1;
+				break;
+			case AttribType::UBYTE4_NORM:
+				return 4;
+				break;
+			case AttribType::HALF2:
+			case AttribType::SHORT2:
+			case AttribType::USHORT2_NORM:
+				return 2;
+				break;
+		}
+
+		return 0;
+	}
+
+	AttribDataType VertexBuffer::getAttribDataType(const AttribType& _type)
+	{
+		switch(_type)
+		{
+			case AttribType::VEC2:
+				return AttribDataType::FLOAT;
+				break;
+			case AttribType::VEC3:
+				return AttribDataType::FLOAT;
+				break;
+			case AttribType::VEC4:
+				return AttribDataType::FLOAT;
+				break;
+			case AttribType::IVEC2:
+				return AttribDataType::INT;
+				break;
+			case AttribType::IVEC3:
+				return AttribDataType::INT;
+				break;
+			case AttribType::IVEC4:
+				return AttribDataType::INT;
+				break;
+			case AttribType::FLOAT:
+				return AttribDataType::FLOAT;
+				break;
+			case AttribType::INT:
+				return AttribDataType::INT;
+				break;
+			case AttribType::UBYTE4_NORM:
+				return AttribDataType::UBYTE_NORM;
+				break;
+			case AttribType::HALF2:
+				return AttribDataType::HALF;
+				break;
+			case AttribType::SHORT2:
+				return AttribDataType::SHORT;
+				break;
+			case AttribType::USHORT2_NORM:
+				return AttribDataType::USHORT_NORM;
+				break;
+		}
+
+		return AttribDataType::INT;
+	}
+
+	unsigned int VertexBuffer::getAttribDataBytes(AttribDataType _type)
+	{
+		switch(_type)
+		{
+			case AttribDataType::FLOAT:
+				return sizeof(float);
+			case AttribDataType::INT:
+				return sizeof(int);
+			case AttribDataType::UBYTE_NORM:
+				return sizeof(uint8_t);
+			case AttribDataType::HALF:
+			case AttribDataType::SHORT:
+			case AttribDataType::USHORT_NORM:
+				return sizeof(uint16_t);
+		}
+
+		return 0;
+	}
+
+	VertexBuffer::~VertexBuffer()
+	{
+		if(m_vbo == 0)
+			return;
+
+		glDeleteBuffers(1, &m_vbo);
+		m_state->bufferDeleted(m_vbo);
+	}
+}
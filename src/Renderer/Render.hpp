@@ -3,55 +3,48 @@
 #include <iostream>
 #include <cstring>
 #include <cmath>
+#include <vector>
 
 #include <glad/glad.h>
 
 #include "Utils/Exceptions.hpp"
 #include "Math/Matrix.hpp"
 #include "Math/Vector.hpp"
+#include "Math/Trig.hpp"
 #include "Window/Window.hpp"
 #include "Opengl/Shader.hpp"
+#include "Opengl/ShaderCompiler.hpp"
 #include "Opengl/Texture.hpp"
+#include "Opengl/StreamBuffer.hpp"
+#include "Opengl/UniformBuffer.hpp"
+#include "Sprite.hpp"
+#include "VertexWriter.hpp"
+#include "RenderTypes.hpp"
+#include "RenderStats.hpp"
+#include "CommandBuffer.hpp"
+#include "StaticBatch.hpp"
 
 namespace Renderer
 {
-	enum class VerticalAlign
-	{
-		DEFAULT, TOP, CENTER, BOTTOM
-	};
-
-	enum class HorizontalAlign
-	{
-		DEFAULT, LEFT, CENTER, RIGHT
-	};
+	/*
+		the values every shader of a Render can read each frame, declared in glsl as
 
-	enum class BlendMode
-	{
-		BLEND,
-		MULTIPLY,
-		ADD,
-		SUBTRACT,
-		REPLACE,
-		IFEMPTY,
-		MIN,
-		MAX
-	};
-
-	enum class DrawType
-	{
-		NONE, POINTS,
-		TRIANGLE, TRIANGLE_STRIP, TRIANGLE_FAN,
-		LINE, LINE_STRIP, LINE_LOOP
-	};
+			layout(std140) uniform RendererFrame
+			{
+				mat4 u_projection;
+				vec2 u_viewport;
+				float u_time;
+			};
 
-	struct RectStyle
+		and connected with Render::bindFrameBlock(). u_time counts seconds since init().
+		u_projection maps pixels of the window unless Render::setProjection() replaced it
+	*/
+	struct FrameBlock
 	{
-		Renderer::Color color;
-		VerticalAlign verticalAlign;
-		HorizontalAlign horizontalAlign;
-		int verticalAlignAmount;
-		int horizontalAlignAmount;
-		float angle;
+		float projection[16];
+		float viewport[2];
+		float time;
+		float padding;
 	};
 
 	class Render
@@ -70,25 +63,95 @@ namespace Renderer
 			unsigned int m_verticesTracker;
 			unsigned int m_indicesTracker;
 
+			// batches are streamed into one large gpu buffer
+			Renderer::StreamBuffer m_streamBuffer;
+
 			// draw types
 			DrawType m_currentDrawType;
+			DrawType m_shapeDrawType;
+
+			// quads share one prebuilt index buffer
+			GLuint m_quadIndexBuffer;
+			unsigned int m_quadIndexCapacity;
+
+			// batches are drawn with 16 or 32 bit indices, each needs its own restart index
+			GLenum m_restartIndexType;
 
 			// default shaders and textures
 			Renderer::Shader* m_defaultShader;
 
+			// rectangles and images as one instance each instead of 4 vertices
+			Renderer::Shader* m_instanceShader;
+
+			// the uniforms of the built in shaders, resolved once in init()
+			Renderer::UniformHandle m_defaultTransform;
+
+			// uploaded once per frame and once per resize for every shader at once
+			Renderer::UniformBuffer m_frameBuffer;
+			FrameBlock m_frameBlock;
+			double m_startTime;
+			bool m_customProjection;
+			bool m_instancing;
+
 			Renderer::Texture* m_whiteTexture;
 
+			// textures sampled by the current batch of the default shader
+			static const unsigned int MAX_TEXTURE_SLOTS = 16;
+			Renderer::Texture* m_textureSlots[MAX_TEXTURE_SLOTS];
+			unsigned int m_textureSlotCount;
+			unsigned int m_textureSlotsUsed;
+
+			RenderStats m_stats;
+
+			// deferred draws are recorded, then sorted and batched in render()
+			bool m_deferred;
+			Renderer::CommandBuffer m_commandBuffer;
+			unsigned char m_layer;
+			Renderer::Shader* m_recordShader;
+			Renderer::Texture* m_recordTexture;
+			BlendMode m_blendMode;
+
 			// for drawing shapes
+			unsigned int m_shapeVertexSize;
+			unsigned char* m_shapeWrite;
 			unsigned int m_shapeVertexTracker;
 			unsigned int m_shapeVertexBytesLeft;
 			unsigned int m_shapeIndexCount;
+			bool m_shapeRestart;
 			unsigned int m_startOfShapeVertexTracker;
 
 			// drawing rectangles
 			RectStyle m_defaultRectStyle;
 
+			// the batches grow when a frame overflows them and shrink after a while of using little
+			static const unsigned int MIN_VERTEX_BATCH_SIZE = 16384;
+			static const unsigned int MAX_VERTEX_BATCH_SIZE = 1 << 26;
+			static const unsigned int MIN_INDEX_BATCH_SIZE = 1024;
+			static const unsigned int MAX_INDEX_BATCH_SIZE = 1 << 24;
+			static const unsigned int SHRINK_COOLDOWN_FRAMES = 300;
+
+			bool m_adaptiveBatching;
+			unsigned int m_requestedStreamSize;
+			unsigned int m_vertexHighWater;
+			unsigned int m_indexHighWater;
+			unsigned int m_vertexOverflows;
+			unsigned int m_indexOverflows;
+			unsigned int m_totalOverflows;
+			unsigned int m_quietFrames;
+			unsigned int m_batchGrows;
+			unsigned int m_batchShrinks;
+
+			// sin and cos of the last angle drawImage() rotated by
+			Renderer::Math::AngleCache m_angleCache;
+
+			// rectangles and images outside the window are skipped
+			bool m_culling;
+			float m_viewportWidth;
+			float m_viewportHeight;
+
 		public:
-			Render(unsigned int _vertexBatchSize = 200000, unsigned int _indexBatchSize = 10000);
+			Render(unsigned int _vertexBatchSize = 200000, unsigned int _indexBatchSize = 10000,
+					unsigned int _streamBufferSize = 1048576);
 			~Render();
 
 			void attach(Renderer::Window* _window);
@@ -96,6 +159,7 @@ namespace Renderer
 
 			void bindShader(Renderer::Shader* _shader = nullptr);
 			void bindTexture(Renderer::Texture* _texture, unsigned int _slot = 0);
+			unsigned int batchTexture(Renderer::Texture* _texture);
 
 			// styles
 			void setColor(const Renderer::Color& _color);
@@ -106,14 +170,43 @@ namespace Renderer
 
 			void setBlendMode(BlendMode blendMode);
 
+			// only the pixels inside the rectangle are drawn to, until clearScissor()
+			void setScissor(int _x, int _y, int _width, int _height);
+			void clearScissor();
+
+			// deferred drawing
+			void setDeferred(bool _deferred);
+			bool isDeferred() const { return m_deferred; };
+			void setLayer(unsigned char _layer) { m_layer = _layer; };
+			void setLayerOrdered(unsigned char _layer, bool _ordered) { m_commandBuffer.setLayerOrdered(_layer, _ordered); };
+
+			// command buffers recorded on other threads, drawn from the GL thread
+			void submit(const Renderer::CommandBuffer& _commandBuffer);
+			void submit(const Renderer::CommandBuffer* _commandBuffers, size_t _count);
+
 			// drawing
 			void drawRect(int _x, int _y, int _width, int _height);
 			void drawRect(int _x, int _y, int _width, int _height, const RectStyle& _style);
 			void drawImage(Renderer::Texture& _texture, int _x, int _y, int _width, int _height);
 			void drawImage(Renderer::Texture& _texture, int _x, int _y, int _width, int _height,
 					const RectStyle& _style);
+			void drawSprites(const Renderer::Sprite* _sprites, size_t _count);
+			void drawStatic(Renderer::StaticBatch& _batch, const Renderer::Mat4<float>* _transform = nullptr);
+
+			void setInstancing(bool _instancing) { m_instancing = _instancing; };
+			bool isInstancing() const { return m_instancing; };
+
+			// batch sizes, adapted on every explicit render() unless turned off
+			void setAdaptiveBatching(bool _adaptive) { m_adaptiveBatching = _adaptive; };
+			bool isAdaptiveBatching() const { return m_adaptiveBatching; };
+			BatchSizing getBatchSizing() const;
+
+			void setCulling(bool _culling) { m_culling = _culling; };
+			bool isCulling() const { return m_culling; };
 
 			void beginShape(DrawType _type, unsigned int _vertexCount, unsigned int _indicesCount);
+			template<typename Vertex>
+			VertexWriter<Vertex> beginShape(DrawType _type, unsigned int _vertexCount, unsigned int _indicesCount = 0);
 			void nextVertex();
 			void vertex1f(float _v);
 			void vertex2f(float _v0, float _v1);
@@ -123,17 +216,78 @@ namespace Renderer
 			void vertex2i(int _v0, int _v1);
 			void vertex3i(int _v0, int _v1, int _v2);
 			void vertex4i(int _v0, int _v1, int _v2, int _v3);
+			// compact attributes: UBYTE4_NORM, HALF2, SHORT2 and USHORT2_NORM
+			void vertex4ub(uint8_t _v0, uint8_t _v1, uint8_t _v2, uint8_t _v3);
+			void vertexColor(const Renderer::Color& _color);
+			void vertex2h(float _v0, float _v1);
+			void vertex2s(int16_t _v0, int16_t _v1);
+			void vertex2us(uint16_t _v0, uint16_t _v1);
+			void vertex2unorm(float _v0, float _v1);
 			void endShape(const unsigned int* _indices);
 			void endShape();
 
 			// render
 			void render();
 
+			// the binding point of the RendererFrame block
+			static const unsigned int FRAME_BLOCK_BINDING = 0;
+			bool bindFrameBlock(Renderer::Shader& _shader);
+
+			// the u_projection of every shader, for cameras and zoom. Culling is off until resetProjection()
+			void setProjection(const Renderer::Mat4<float>& _projection);
+			void resetProjection();
+			bool hasCustomProjection() const { return m_customProjection; };
+
 			Renderer::Window* getWindow() { return m_window; };
+			Renderer::Shader* getDefaultShader() { return m_defaultShader; };
+			const StreamStats& getStreamStats() const { return m_streamBuffer.getStats(); };
+			const RenderStats& getStats() const { return m_stats; };
+			void resetStats();
+
+			// the state cache of the window's context, counts the GL calls it skipped
+			Renderer::GLState& getStateCache() { return m_window->getState(); };
 		private:
+			void assertShapeComplete();
 			void assertShapeVertexSafeToStore(unsigned int _bytesRequired);
+			void storeShapeData(const void* _data, unsigned int _bytes);
+			void reserveQuadIndices(unsigned int _quadCount);
+			void replayCommands();
+			void flush(FlushReason _reason);
+			void discardBatch();
+			void drawSpriteInstances(const Renderer::Sprite* _sprites, size_t _count);
+			void drawRecordedSprites(const unsigned int* _indices, size_t _count);
+			void renderInstances(FlushReason _reason);
+			void setRestartIndex(GLenum _indexType);
+			void updateFrameBlock(float _width, float _height);
+			void adaptBatches();
+			void fitBatches(unsigned int _vertexBytes, unsigned int _indexCount);
+			void resizeBatches(unsigned int _vertexBatchSize, unsigned int _indexBatchSize);
+
+			static unsigned int streamBufferSize(unsigned int _vertexBatchSize, unsigned int _indexBatchSize,
+					unsigned int _streamBufferSize);
 	};
 
+	template<typename Vertex>
+	VertexWriter<Vertex> Render::beginShape(DrawType _type, unsigned int _vertexCount, unsigned int _indicesCount)
+	{
+		beginShape(_type, _vertexCount, _indicesCount);
+
+#ifndef NDEBUG
+		if(m_shapeVertexSize != sizeof(Vertex))
+			throw Renderer::RenderingException("The vertex struct does not match the vertex layout of the shader!");
+#endif
+
+		// whole vertices only, endShape() expects the tracker back at 1
+		m_shapeVertexBytesLeft = 0;
+#ifndef NDEBUG
+		m_shapeVertexTracker = _vertexCount + 1;
+		return VertexWriter<Vertex>(m_shapeWrite, _vertexCount, &m_shapeVertexTracker);
+#else
+		m_shapeVertexTracker = 1;
+		return VertexWriter<Vertex>(m_shapeWrite, _vertexCount);
+#endif
+	}
+
 	class RendererWindowEvent : public Renderer::WindowEvents
 	{
 		private:
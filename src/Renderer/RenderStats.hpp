@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+
+// compile the library with RENDERER_NO_STATS to leave out all the counting
+#ifdef RENDERER_NO_STATS
+#define RENDERER_STAT(_statement)
+#else
+#define RENDERER_STAT(_statement) _statement
+#endif
+
+namespace Renderer
+{
+	// why a batch was drawn
+	enum class FlushReason
+	{
+		EXPLICIT,			// render() was called
+		SHADER_CHANGE,		// bindShader() with another shader
+		TEXTURE_CHANGE,		// bindTexture() with another texture
+		TEXTURE_SLOTS_FULL,	// batchTexture() ran out of texture slots
+		DRAW_TYPE_CHANGE,	// a shape of another DrawType was started
+		BATCH_FULL,			// the vertex or index batch had no room left
+		BLEND_MODE_CHANGE,	// the blend mode changed
+		MODE_CHANGE,		// setDeferred() switched between immediate and deferred
+		STATIC_BATCH,		// drawStatic(), its own draws count here too
+		SCISSOR_CHANGE,		// setScissor() or clearScissor() changed the rectangle
+		PROJECTION_CHANGE,	// setProjection() or resetProjection()
+		COUNT
+	};
+
+	inline const char* flushReasonName(FlushReason _reason)
+	{
+		switch(_reason)
+		{
+			case FlushReason::EXPLICIT:
+				return "explicit";
+			case FlushReason::SHADER_CHANGE:
+				return "shader change";
+			case FlushReason::TEXTURE_CHANGE:
+				return "texture change";
+			case FlushReason::TEXTURE_SLOTS_FULL:
+				return "texture slots full";
+			case FlushReason::DRAW_TYPE_CHANGE:
+				return "draw type change";
+			case FlushReason::BATCH_FULL:
+				return "batch full";
+			case FlushReason::BLEND_MODE_CHANGE:
+				return "blend mode change";
+			case FlushReason::MODE_CHANGE:
+				return "mode change";
+			case FlushReason::STATIC_BATCH:
+				return "static batch";
+			case FlushReason::SCISSOR_CHANGE:
+				return "scissor change";
+			case FlushReason::PROJECTION_CHANGE:
+				return "projection change";
+			default:
+				return "unknown";
+		}
+	}
+
+	/*
+		counters since the last Render::resetStats(), usually reset once per frame. Every draw
+		call counts towards exactly one FlushReason. The layout is the same with
+		RENDERER_NO_STATS, the counters just stay 0.
+	*/
+	struct RenderStats
+	{
+		unsigned int drawCalls;
+		unsigned int sprites;
+		unsigned int culled;
+		unsigned int instances;
+		unsigned int vertices;
+		unsigned int indices;
+		size_t bytesUploaded;
+		unsigned int flushes[static_cast<int>(FlushReason::COUNT)];
+
+		float spritesPerDraw() const { return drawCalls > 0 ? static_cast<float>(sprites) / drawCalls : 0.f; };
+		unsigned int flushCount(FlushReason _reason) const { return flushes[static_cast<int>(_reason)]; };
+	};
+
+	// the current batch sizes of a Render and how they got there, counted since it was created
+	struct BatchSizing
+	{
+		unsigned int vertexBatchSize;
+		unsigned int indexBatchSize;
+		unsigned int streamBufferSize;
+		unsigned int overflows;
+		unsigned int grows;
+		unsigned int shrinks;
+	};
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Opengl/Texture.hpp"
+
+namespace Renderer
+{
+	enum class VerticalAlign
+	{
+		DEFAULT, TOP, CENTER, BOTTOM
+	};
+
+	enum class HorizontalAlign
+	{
+		DEFAULT, LEFT, CENTER, RIGHT
+	};
+
+	enum class BlendMode
+	{
+		BLEND,
+		MULTIPLY,
+		ADD,
+		SUBTRACT,
+		REPLACE,
+		IFEMPTY,
+		MIN,
+		MAX
+	};
+
+	enum class DrawType
+	{
+		NONE, POINTS,
+		TRIANGLE, TRIANGLE_STRIP, TRIANGLE_FAN,
+		LINE, LINE_STRIP, LINE_LOOP,
+		QUAD
+	};
+
+	// ends the current strip, fan or loop so the next shape starts a new one in the same draw call
+	const unsigned int PRIMITIVE_RESTART_INDEX = 0xFFFFFFFF;
+
+	inline bool isStripType(DrawType _type)
+	{
+		return _type == DrawType::TRIANGLE_STRIP || _type == DrawType::TRIANGLE_FAN
+			|| _type == DrawType::LINE_STRIP || _type == DrawType::LINE_LOOP;
+	}
+
+	// the indices a shape of _vertexCount vertices uses when it is not given any
+	inline unsigned int defaultIndexCount(DrawType _type, unsigned int _vertexCount)
+	{
+		switch(_type)
+		{
+			case DrawType::QUAD:
+				return 6 * (_vertexCount / 4);
+			case DrawType::TRIANGLE:
+				return 3 * (_vertexCount - 2);
+			default:
+				return _vertexCount;
+		}
+	}
+
+	struct RectStyle
+	{
+		Renderer::Color color;
+		VerticalAlign verticalAlign;
+		HorizontalAlign horizontalAlign;
+		int verticalAlignAmount;
+		int horizontalAlignAmount;
+		float angle;
+	};
+}
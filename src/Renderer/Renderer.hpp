@@ -2,7 +2,19 @@
 
 #include "Math/Vector.hpp"
 #include "Math/Matrix.hpp"
+#include "Math/Trig.hpp"
 #include "Window/Window.hpp"
+#include "Opengl/GLState.hpp"
+#include "Opengl/VertexBuffer.hpp"
+#include "Opengl/ProgramCache.hpp"
 #include "Opengl/Shader.hpp"
+#include "Opengl/ShaderCompiler.hpp"
+#include "Opengl/ShaderWatcher.hpp"
 #include "Opengl/Texture.hpp"
+#include "Opengl/StreamBuffer.hpp"
+#include "Opengl/UniformBuffer.hpp"
+#include "Sprite.hpp"
+#include "VertexWriter.hpp"
+#include "RenderStats.hpp"
+#include "StaticBatch.hpp"
 #include "Render.hpp"
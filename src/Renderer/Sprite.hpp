@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+
+#include "Opengl/Texture.hpp"
+#include "RenderTypes.hpp"
+#include "VertexWriter.hpp"
+#include "Utils/Pack.hpp"
+#include "Math/Trig.hpp"
+
+namespace Renderer
+{
+	/*
+		one textured rectangle for Render::drawSprites(). (alignX, alignY) is the point of the
+		sprite placed at (x, y) and rotated around, measured from its top left like
+		RectStyle::horizontalAlignAmount. (u0, v0) and (u1, v1) are the bottom left and top
+		right of the texture region, 0, 0, 1, 1 draws the whole image like drawImage() does.
+	*/
+	struct Sprite
+	{
+		Renderer::Texture* texture;
+		float x;
+		float y;
+		float width;
+		float height;
+		float angle;
+		float alignX;
+		float alignY;
+		Renderer::Color color;
+		float u0;
+		float v0;
+		float u1;
+		float v1;
+	};
+
+	// one sprite of the instanced path, the shader builds the 4 corners from it
+	struct SpriteInstance
+	{
+		float x;
+		float y;
+		float width;
+		float height;
+		float alignX;
+		float alignY;
+		float angle;
+		float u0;
+		float v0;
+		float u1;
+		float v1;
+		unsigned int color;
+		int textureSlot;
+	};
+
+	// the sprite drawImage() draws, the alignment of _style resolved against the size
+	Sprite rectSprite(Renderer::Texture* _texture, int _x, int _y, int _width, int _height, const RectStyle& _style);
+
+	// whether the rotated bounding box of the sprite overlaps the viewport from 0, 0 to _width, _height
+	bool spriteVisible(const Sprite& _sprite, float _width, float _height);
+	bool spriteVisible(const Sprite& _sprite, float _sin, float _cos, float _width, float _height);
+
+	/*
+		x0 y0 x1 y1 x2 y2 x3 y3 of the top left, bottom left, bottom right and top right corners,
+		rotated by the angle whose sin and cos are passed in. Unrotated sprites skip the rotation
+		and ignore them
+	*/
+	void spriteCorners(const Sprite& _sprite, float _sin, float _cos, float* _positions);
+
+	// writes 4 default shader vertices per sprite into _vertices, all sampling _textureSlot
+	void spriteVertices(const Sprite* _sprites, size_t _count, int _textureSlot, DefaultVertex* _vertices);
+
+	// writes one instance per sprite, the color packed as rgba bytes
+	void spriteInstances(const Sprite* _sprites, size_t _count, int _textureSlot, SpriteInstance* _instances);
+}
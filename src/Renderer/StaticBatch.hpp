@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "Opengl/Shader.hpp"
+#include "Opengl/Texture.hpp"
+#include "Opengl/GLState.hpp"
+#include "RenderTypes.hpp"
+#include "CommandBuffer.hpp"
+
+namespace Renderer
+{
+	// one draw call of a static batch
+	struct StaticSegment
+	{
+		static const unsigned int MAX_TEXTURES = 16;
+
+		Renderer::Shader* shader;
+		Renderer::Texture* textures[MAX_TEXTURES];
+		unsigned int textureCount;
+		BlendMode blendMode;
+		GLenum drawType;
+		unsigned int indexOffset; // in bytes
+		unsigned int indexCount;
+		unsigned int baseVertex;
+	};
+
+	/*
+		geometry that does not change between frames. It is recorded once through the
+		CommandBuffer api, built into its own vertex and index buffer the next time it is
+		drawn with Render::drawStatic() and then replayed with one draw call per shader,
+		texture set and blend mode. Changing the recorded commands only takes effect after
+		markDirty().
+	*/
+	class StaticBatch
+	{
+		private:
+			Renderer::CommandBuffer m_commands;
+
+			Renderer::GLState* m_state;
+
+			GLuint m_vbo;
+			GLuint m_ibo;
+			GLenum m_indexType;
+			std::vector<StaticSegment> m_segments;
+
+			bool m_dirty;
+
+		public:
+			StaticBatch();
+			~StaticBatch();
+
+			Renderer::CommandBuffer& getCommandBuffer() { return m_commands; };
+			void markDirty() { m_dirty = true; };
+			bool isDirty() const { return m_dirty; };
+			void clear();
+
+			void build(Renderer::Shader* _defaultShader, Renderer::Texture* _whiteTexture, unsigned int _textureSlotCount,
+					Renderer::GLState& _state);
+
+			GLuint getVertexBuffer() const { return m_vbo; };
+			GLuint getIndexBuffer() const { return m_ibo; };
+			GLenum getIndexType() const { return m_indexType; };
+			const std::vector<StaticSegment>& getSegments() const { return m_segments; };
+
+		private:
+			static GLenum glDrawType(DrawType _type);
+	};
+}
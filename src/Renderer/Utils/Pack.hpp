@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace Renderer
+{
+	namespace Pack
+	{
+		// 0 to 1 into 0 to 255, clamped
+		inline uint8_t unorm8(float _value)
+		{
+			if(_value <= 0.f)
+				return 0;
+			if(_value >= 1.f)
+				return 255;
+
+			return static_cast<uint8_t>(_value * 255.f + 0.5f);
+		}
+
+		// 0 to 1 into 0 to 65535, clamped
+		inline uint16_t unorm16(float _value)
+		{
+			if(_value <= 0.f)
+				return 0;
+			if(_value >= 1.f)
+				return 65535;
+
+			return static_cast<uint16_t>(_value * 65535.f + 0.5f);
+		}
+
+		// a 0 to 255 color channel, clamped
+		inline uint8_t channel(int _value)
+		{
+			return static_cast<uint8_t>(_value < 0 ? 0 : (_value > 255 ? 255 : _value));
+		}
+
+		// IEEE half float, rounded towards zero. Values too large become infinity, too small become 0
+		inline uint16_t half(float _value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &_value, sizeof(float));
+
+			uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+			int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+			uint32_t mantissa = bits & 0x7FFFFF;
+
+			// nan stays nan, infinity and overflow become infinity
+			if(((bits >> 23) & 0xFF) == 0xFF)
+				return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+			if(exponent >= 0x1F)
+				return sign | 0x7C00;
+
+			// subnormal halfs keep the implicit leading bit in the mantissa
+			if(exponent <= 0)
+			{
+				if(exponent < -10)
+					return sign;
+
+				mantissa |= 0x800000;
+				return sign | static_cast<uint16_t>(mantissa >> (14 - exponent));
+			}
+
+			return sign | static_cast<uint16_t>(exponent << 10) | static_cast<uint16_t>(mantissa >> 13);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#include "Utils/Exceptions.hpp"
+
+namespace Renderer
+{
+	/*
+		the packed vertex layout of the default shader, 20 bytes: position, rgba color
+		bytes, texture coordinates from 0 to 65535 and the texture slot
+	*/
+	struct DefaultVertex
+	{
+		float x;
+		float y;
+		uint8_t r;
+		uint8_t g;
+		uint8_t b;
+		uint8_t a;
+		uint16_t u;
+		uint16_t v;
+		int16_t textureSlot;
+		int16_t padding;
+	};
+
+	/*
+		fills the vertices of one shape started with Render::beginShape<Vertex>(). Vertex is a
+		plain struct laid out like the attributes of the bound shader, so each vertex() is a
+		single copy of a known size. Running past the reserved vertices is only checked in
+		debug builds, where a writer given the vertex tracker of its Render also counts the
+		vertices down so endShape() can tell an under-filled shape.
+	*/
+	template<typename Vertex>
+	class VertexWriter
+	{
+		static_assert(std::is_trivially_copyable<Vertex>::value, "Vertex must be trivially copyable!");
+
+		private:
+			unsigned char* m_write;
+#ifndef NDEBUG
+			unsigned char* m_end;
+			unsigned int* m_vertexTracker;
+#endif
+
+		public:
+			VertexWriter(unsigned char* _write, unsigned int _vertexCount, unsigned int* _vertexTracker = nullptr)
+				: m_write(_write)
+#ifndef NDEBUG
+				, m_end(_write + sizeof(Vertex) * _vertexCount), m_vertexTracker(_vertexTracker)
+#endif
+			{
+			}
+
+			void vertex(const Vertex& _vertex)
+			{
+#ifndef NDEBUG
+				if(m_write + sizeof(Vertex) > m_end)
+					throw Renderer::RenderingException("Too many vertices are passed in! Please call beginShape() with the correct number of vertices!");
+
+				if(m_vertexTracker)
+					-- *m_vertexTracker;
+#endif
+				// the batch is not aligned for Vertex, memcpy still becomes a plain store
+				memcpy(m_write, &_vertex, sizeof(Vertex));
+				m_write += sizeof(Vertex);
+			}
+	};
+}
@@ -10,6 +10,7 @@
 #include <stb_image/stb_image.h>
 
 #include "./../Utils/Exceptions.hpp"
+#include "./../Opengl/GLState.hpp"
 
 namespace Renderer
 {
@@ -61,6 +62,9 @@ namespace Renderer
 
 			bool m_autoMakeCurrent;
 
+			// every window has its own context and with it its own state
+			Renderer::GLState m_glState;
+
 		public:
 			Window(bool _autoMakeCurrent = false);
 			~Window();
@@ -92,6 +96,7 @@ namespace Renderer
 			bool isFullScreen() const { return m_fullscreen; };
 			bool isCurrentContext() const;
 			bool willAutoMakeCurrent() const { return m_autoMakeCurrent; };
+			Renderer::GLState& getState() { return m_glState; };
 			std::string getWindowTitle() const { return m_windowTitle; };
 			bool onFocus() const { return glfwGetWindowAttrib(m_window, GLFW_FOCUSED) == GLFW_TRUE; };
 
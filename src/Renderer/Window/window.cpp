@@ -100,7 +100,7 @@ namespace Renderer
 		// set the viewport size
 		int framebuffer_width, framebuffer_height;
 		glfwGetFramebufferSize(m_window, &framebuffer_width, &framebuffer_height);
-		glViewport(0, 0, framebuffer_width, framebuffer_height);
+		m_glState.viewport(0, 0, framebuffer_width, framebuffer_height);
 	}
 
 	void Window::resize(unsigned int _width, unsigned int _height)
@@ -317,7 +317,7 @@ namespace Renderer
 	{
 		Window* window_instance = reinterpret_cast<Window*>(glfwGetWindowUserPointer(_window));
 		window_instance->makeCurrent();
-		glViewport(0, 0, _width, _height);
+		window_instance->m_glState.viewport(0, 0, _width, _height);
 	}
 
 	void Window::GLFWWindowResizeEvent(GLFWwindow* _window, int _width, int _height)
@@ -0,0 +1,220 @@
+#include "CommandBuffer.hpp"
+
+namespace Renderer
+{
+	CommandBuffer::CommandBuffer()
+		: m_sequence(0), m_layer(0), m_blendMode(BlendMode::BLEND)
+	{
+		for(unsigned int i=0;i<256;++i)
+			m_orderedLayers[i] = false;
+	}
+
+	void CommandBuffer::drawRect(int _x, int _y, int _width, int _height, const RectStyle& _style)
+	{
+		// no texture is drawn with the white texture of the render
+		recordSprite(Renderer::rectSprite(nullptr, _x, _y, _width, _height, _style), m_layer, m_blendMode);
+	}
+
+	void CommandBuffer::drawImage(Renderer::Texture& _texture, int _x, int _y, int _width, int _height,
+			const RectStyle& _style)
+	{
+		recordSprite(Renderer::rectSprite(&_texture, _x, _y, _width, _height, _style), m_layer, m_blendMode);
+	}
+
+	void CommandBuffer::drawSprites(const Renderer::Sprite* _sprites, size_t _count)
+	{
+		// the vertices of the whole call at once, sprites sharing an angle share its sin and cos
+		unsigned int first_vertex = m_spriteVertices.size();
+		m_spriteVertices.resize(first_vertex + 4 * _count);
+		Renderer::spriteVertices(_sprites, _count, 0, m_spriteVertices.data() + first_vertex);
+
+		for(size_t i=0;i<_count;++i)
+		{
+			uint64_t key = sortKey(m_layer, m_blendMode, nullptr, DrawType::QUAD, _sprites[i].texture);
+			m_commands.push_back({ key, CommandType::SPRITE, m_blendMode, static_cast<unsigned int>(m_sprites.size()) });
+			m_sprites.push_back(_sprites[i]);
+		}
+	}
+
+	unsigned char* CommandBuffer::beginShape(Renderer::Shader* _shader, Renderer::Texture* _texture, DrawType _type,
+			unsigned int _vertexCount, unsigned int _indexCount)
+	{
+		if(!_shader)
+			throw Renderer::RenderingException("Recorded shapes need a shader to know their vertex size!");
+
+		if(_type == DrawType::QUAD && _vertexCount % 4 != 0)
+			throw Renderer::RenderingException("Quads must be made of 4 vertices each!");
+
+		return recordShape(_shader, _texture, _type, _vertexCount, _indexCount, m_layer, m_blendMode);
+	}
+
+	void CommandBuffer::endShape(const unsigned int* _indices)
+	{
+		if(m_shapes.empty())
+			throw Renderer::RenderingException("There is no recorded shape to add the indices to!");
+
+		// a shape begun without an index count takes as many indices as Render::beginShape() would
+		const ShapeCommand& shape = m_shapes.back();
+		recordShapeIndices(_indices, shape.indexCount > 0 ? shape.indexCount : defaultIndexCount(shape.type, shape.vertexCount));
+	}
+
+	void CommandBuffer::recordSprite(const Renderer::Sprite& _sprite, unsigned char _layer, BlendMode _blendMode)
+	{
+		uint64_t key = sortKey(_layer, _blendMode, nullptr, DrawType::QUAD, _sprite.texture);
+		m_commands.push_back({ key, CommandType::SPRITE, _blendMode, static_cast<unsigned int>(m_sprites.size()) });
+		m_sprites.push_back(_sprite);
+
+		m_spriteVertices.resize(m_spriteVertices.size() + 4);
+		Renderer::spriteVertices(&_sprite, 1, 0, m_spriteVertices.data() + m_spriteVertices.size() - 4);
+	}
+
+	unsigned char* CommandBuffer::recordShape(Renderer::Shader* _shader, Renderer::Texture* _texture, DrawType _type,
+			unsigned int _vertexCount, unsigned int _indexCount, unsigned char _layer, BlendMode _blendMode)
+	{
+		uint64_t key = sortKey(_layer, _blendMode, _shader, _type, _texture);
+		m_commands.push_back({ key, CommandType::SHAPE, _blendMode, static_cast<unsigned int>(m_shapes.size()) });
+
+		unsigned int vertex_offset = m_vertices.size();
+		m_vertices.resize(vertex_offset + _shader->getVertexBitSize() * _vertexCount);
+
+		m_shapes.push_back({
+			_shader, _texture, _type,
+			vertex_offset, _vertexCount,
+			static_cast<unsigned int>(m_indices.size()), _indexCount,
+			false
+		});
+
+		return m_vertices.data() + vertex_offset;
+	}
+
+	void CommandBuffer::recordShapeIndices(const unsigned int* _indices, unsigned int _indexCount)
+	{
+		if(m_shapes.empty())
+			throw Renderer::RenderingException("There is no recorded shape to add the indices to!");
+
+		ShapeCommand& shape = m_shapes.back();
+		shape.indexOffset = m_indices.size();
+		shape.indexCount = _indexCount;
+		shape.customIndices = true;
+
+		m_indices.insert(m_indices.end(), _indices, _indices + _indexCount);
+	}
+
+	void CommandBuffer::append(const CommandBuffer& _commandBuffer)
+	{
+		unsigned int sprite_base = m_sprites.size();
+		unsigned int shape_base = m_shapes.size();
+		unsigned int vertex_base = m_vertices.size();
+		unsigned int index_base = m_indices.size();
+
+		m_sprites.insert(m_sprites.end(), _commandBuffer.m_sprites.begin(), _commandBuffer.m_sprites.end());
+		m_spriteVertices.insert(m_spriteVertices.end(), _commandBuffer.m_spriteVertices.begin(),
+				_commandBuffer.m_spriteVertices.end());
+		m_vertices.insert(m_vertices.end(), _commandBuffer.m_vertices.begin(), _commandBuffer.m_vertices.end());
+		m_indices.insert(m_indices.end(), _commandBuffer.m_indices.begin(), _commandBuffer.m_indices.end());
+		for(ShapeCommand shape : _commandBuffer.m_shapes)
+		{
+			shape.vertexOffset += vertex_base;
+			shape.indexOffset += index_base;
+			m_shapes.push_back(shape);
+		}
+
+		// the keys are made again so the commands follow everything recorded here so far
+		m_commands.reserve(m_commands.size() + _commandBuffer.m_commands.size());
+		for(const DrawCommand& command : _commandBuffer.m_commands)
+		{
+			unsigned char layer = static_cast<unsigned char>(command.key >> 56);
+			if(command.type == CommandType::SPRITE)
+			{
+				unsigned int index = sprite_base + command.index;
+				uint64_t key = sortKey(layer, command.blendMode, nullptr, DrawType::QUAD, m_sprites[index].texture);
+				m_commands.push_back({ key, CommandType::SPRITE, command.blendMode, index });
+			} else
+			{
+				unsigned int index = shape_base + command.index;
+				const ShapeCommand& shape = m_shapes[index];
+				uint64_t key = sortKey(layer, command.blendMode, shape.shader, shape.type, shape.texture);
+				m_commands.push_back({ key, CommandType::SHAPE, command.blendMode, index });
+			}
+		}
+	}
+
+	void CommandBuffer::sort()
+	{
+		if(m_commands.empty())
+			return;
+
+		// least significant digit radix sort, one byte of the key per pass
+		m_sortScratch.resize(m_commands.size());
+		for(unsigned int pass=0;pass<8;++pass)
+		{
+			unsigned int shift = pass * 8;
+			unsigned int counts[256] = { 0 };
+			for(const DrawCommand& command : m_commands)
+				++ counts[(command.key >> shift) & 0xFF];
+
+			// every key shares this byte, the pass would not move anything
+			if(counts[(m_commands.front().key >> shift) & 0xFF] == m_commands.size())
+				continue;
+
+			unsigned int offset = 0;
+			for(unsigned int i=0;i<256;++i)
+			{
+				unsigned int count = counts[i];
+				counts[i] = offset;
+				offset += count;
+			}
+
+			for(const DrawCommand& command : m_commands)
+				m_sortScratch[counts[(command.key >> shift) & 0xFF] ++] = command;
+
+			m_commands.swap(m_sortScratch);
+		}
+	}
+
+	void CommandBuffer::clear()
+	{
+		m_commands.clear();
+		m_sprites.clear();
+		m_spriteVertices.clear();
+		m_shapes.clear();
+		m_vertices.clear();
+		m_indices.clear();
+		m_shaderIds.clear();
+		m_textureIds.clear();
+		m_sequence = 0;
+	}
+
+	uint64_t CommandBuffer::sortKey(unsigned char _layer, BlendMode _blendMode, const Renderer::Shader* _shader,
+			DrawType _type, const Renderer::Texture* _texture)
+	{
+		// 3 bits blend mode, 8 bits shader, 4 bits draw type, 9 bits texture
+		uint64_t state = static_cast<uint64_t>(_blendMode) << 21;
+		state |= static_cast<uint64_t>(compactId(m_shaderIds, _shader, 0xFF)) << 13;
+		state |= static_cast<uint64_t>(_type) << 9;
+		state |= compactId(m_textureIds, _texture, 0x1FF);
+
+		uint64_t sequence = m_sequence ++;
+		uint64_t key = static_cast<uint64_t>(_layer) << 56;
+		if(m_orderedLayers[_layer])
+			return key | (sequence << 24) | state;
+
+		return key | (state << 32) | sequence;
+	}
+
+	unsigned int CommandBuffer::compactId(std::unordered_map<const void*, unsigned int>& _ids, const void* _pointer,
+			unsigned int _maxId)
+	{
+		std::unordered_map<const void*, unsigned int>::iterator it = _ids.find(_pointer);
+		if(it != _ids.end())
+			return it->second;
+
+		// out of ids, the rest only lose their grouping, not their correctness
+		if(_ids.size() >= _maxId)
+			return _maxId;
+
+		unsigned int id = _ids.size();
+		_ids.insert({ _pointer, id });
+		return id;
+	}
+}
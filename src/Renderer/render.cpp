@@ -5,17 +5,63 @@ static const char* default_vertex_shader = R"(
 layout (location = 0) in vec2 a_position;
 layout (location = 1) in vec4 a_color;
 layout (location = 2) in vec2 a_texCoord;
+layout (location = 3) in float a_texIndex;
 
-uniform mat4 u_projection;
+layout(std140) uniform RendererFrame
+{
+	mat4 u_projection;
+	vec2 u_viewport;
+	float u_time;
+};
+uniform mat4 u_transform;
 
 out vec4 v_color;
 out vec2 v_texCoord;
+flat out int v_texIndex;
 
 void main()
 {
-	gl_Position = u_projection * vec4(a_position, 0.0, 1.0);
+	gl_Position = u_projection * u_transform * vec4(a_position, 0.0, 1.0);
 	v_color = a_color;
 	v_texCoord = a_texCoord;
+	v_texIndex = int(a_texIndex + 0.5);
+}
+)";
+
+// one sprite per instance, the corners come from the quad index buffer
+static const char* instance_vertex_shader = R"(
+#version 410 core
+layout (location = 0) in vec4 a_rect;
+layout (location = 1) in vec3 a_transform;
+layout (location = 2) in vec4 a_texRect;
+layout (location = 3) in int a_color;
+layout (location = 4) in int a_texIndex;
+
+layout(std140) uniform RendererFrame
+{
+	mat4 u_projection;
+	vec2 u_viewport;
+	float u_time;
+};
+
+out vec4 v_color;
+out vec2 v_texCoord;
+flat out int v_texIndex;
+
+void main()
+{
+	// top left, bottom left, bottom right, top right
+	vec2 corner = vec2(gl_VertexID >= 2 ? 1.0 : 0.0, (gl_VertexID == 1 || gl_VertexID == 2) ? 1.0 : 0.0);
+	vec2 local = corner * a_rect.zw - a_transform.xy;
+
+	float cos_ang = cos(a_transform.z);
+	float sin_ang = sin(a_transform.z);
+	vec2 position = vec2(cos_ang * local.x - sin_ang * local.y, sin_ang * local.x + cos_ang * local.y) + a_rect.xy;
+
+	gl_Position = u_projection * vec4(position, 0.0, 1.0);
+	v_color = unpackUnorm4x8(uint(a_color));
+	v_texCoord = vec2(mix(a_texRect.x, a_texRect.z, corner.x), mix(a_texRect.w, a_texRect.y, corner.y));
+	v_texIndex = a_texIndex;
 }
 )";
 
@@ -23,26 +69,61 @@ static const char* default_fragment_shader = R"(
 #version 410 core
 in vec4 v_color;
 in vec2 v_texCoord;
+flat in int v_texIndex;
 
-uniform sampler2D u_texture;
+uniform sampler2D u_textures[16];
 
 out vec4 FragColor;
 
 void main()
 {
-	vec4 texel = texture(u_texture, v_texCoord);
+	// samplers can only be indexed by constants when the index varies per vertex
+	vec4 texel;
+	switch(v_texIndex)
+	{
+		case 0: texel = texture(u_textures[0], v_texCoord); break;
+		case 1: texel = texture(u_textures[1], v_texCoord); break;
+		case 2: texel = texture(u_textures[2], v_texCoord); break;
+		case 3: texel = texture(u_textures[3], v_texCoord); break;
+		case 4: texel = texture(u_textures[4], v_texCoord); break;
+		case 5: texel = texture(u_textures[5], v_texCoord); break;
+		case 6: texel = texture(u_textures[6], v_texCoord); break;
+		case 7: texel = texture(u_textures[7], v_texCoord); break;
+		case 8: texel = texture(u_textures[8], v_texCoord); break;
+		case 9: texel = texture(u_textures[9], v_texCoord); break;
+		case 10: texel = texture(u_textures[10], v_texCoord); break;
+		case 11: texel = texture(u_textures[11], v_texCoord); break;
+		case 12: texel = texture(u_textures[12], v_texCoord); break;
+		case 13: texel = texture(u_textures[13], v_texCoord); break;
+		case 14: texel = texture(u_textures[14], v_texCoord); break;
+		default: texel = texture(u_textures[15], v_texCoord); break;
+	}
 	FragColor = v_color * texel;
 }
 )";
 
 namespace Renderer
 {
-	Render::Render(unsigned int _vertexBatchSize, unsigned int _indexBatchSize)
-		: m_window(nullptr), m_verticesTracker(0), m_indicesTracker(0), m_defaultShader(nullptr),
+	Render::Render(unsigned int _vertexBatchSize, unsigned int _indexBatchSize, unsigned int _streamBufferSize)
+		: m_window(nullptr), m_verticesTracker(0), m_indicesTracker(0),
+		m_streamBuffer(streamBufferSize(_vertexBatchSize, _indexBatchSize, _streamBufferSize),
+				_streamBufferSize > 0 ? StreamMode::RING : StreamMode::ORPHAN),
+		m_defaultShader(nullptr),
 		m_currentDrawType(DrawType::NONE), m_whiteTexture(nullptr), m_shapeVertexTracker(0), m_shapeVertexBytesLeft(0),
-		m_shapeIndexCount(0), m_startOfShapeVertexTracker(0), m_vertexBatchSize(_vertexBatchSize),
-		m_indexBatchSize(_indexBatchSize)
+		m_shapeIndexCount(0), m_shapeRestart(false), m_startOfShapeVertexTracker(0), m_vertexBatchSize(_vertexBatchSize),
+		m_indexBatchSize(_indexBatchSize), m_shapeDrawType(DrawType::NONE), m_quadIndexBuffer(0), m_quadIndexCapacity(0),
+		m_textureSlotCount(1), m_textureSlotsUsed(0), m_stats(), m_deferred(false), m_layer(0),
+		m_recordShader(nullptr), m_recordTexture(nullptr), m_blendMode(BlendMode::BLEND), m_shapeVertexSize(0),
+		m_shapeWrite(nullptr), m_instanceShader(nullptr), m_instancing(false), m_restartIndexType(GL_UNSIGNED_INT), m_culling(true),
+		m_viewportWidth(0.f), m_viewportHeight(0.f), m_defaultTransform({ -1 }), m_startTime(0.0),
+		m_customProjection(false),
+		m_adaptiveBatching(true), m_requestedStreamSize(_streamBufferSize),
+		m_vertexHighWater(0), m_indexHighWater(0), m_vertexOverflows(0), m_indexOverflows(0), m_totalOverflows(0),
+		m_quietFrames(0), m_batchGrows(0), m_batchShrinks(0)
 	{
+		for(unsigned int i=0;i<MAX_TEXTURE_SLOTS;++i)
+			m_textureSlots[i] = nullptr;
+
 		m_verticesBatch = new unsigned char[_vertexBatchSize];
 		m_indicesBatch = new unsigned int[_indexBatchSize];
 		m_defaultRectStyle = {
@@ -70,91 +151,253 @@ namespace Renderer
 		glEnable(GL_BLEND);
 		setBlendMode(BlendMode::BLEND);
 
+		// strips, fans and loops of one batch are split by the restart index
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(PRIMITIVE_RESTART_INDEX);
+		m_restartIndexType = GL_UNSIGNED_INT;
+
+		m_streamBuffer.create(m_window->getState());
+
+		// both built in shaders compile at once, each is finished when it is first used
+		Renderer::ShaderCompiler shader_compiler;
 		m_defaultShader = new Renderer::Shader;
 		m_defaultShader->attach(m_window);
-		m_defaultShader->create(default_vertex_shader, default_fragment_shader);
+		shader_compiler.add(*m_defaultShader, default_vertex_shader, default_fragment_shader);
+
+		m_instanceShader = new Renderer::Shader;
+		m_instanceShader->attach(m_window);
+		shader_compiler.add(*m_instanceShader, instance_vertex_shader, default_fragment_shader);
+
 		// shader attributes
 		m_defaultShader->vertexAttribAdd(0, Renderer::AttribType::VEC2);
-		m_defaultShader->vertexAttribAdd(1, Renderer::AttribType::VEC4);
-		m_defaultShader->vertexAttribAdd(2, Renderer::AttribType::VEC2);
+		m_defaultShader->vertexAttribAdd(1, Renderer::AttribType::UBYTE4_NORM);
+		m_defaultShader->vertexAttribAdd(2, Renderer::AttribType::USHORT2_NORM);
+		m_defaultShader->vertexAttribAdd(3, Renderer::AttribType::SHORT2);
 		m_defaultShader->vertexAttribsEnable();
 		// shader uniforms
-		m_defaultShader->uniformAdd("u_projection", Renderer::UniformType::MAT4);
-		m_defaultShader->uniformAdd("u_texture", Renderer::UniformType::INT);
-		m_defaultShader->setUniformInt("u_texture", 0);
-
-		Renderer::Mat4<float> projection = Renderer::Math::projection2D(
-				0.f, static_cast<float>(m_window->getWidth()),
-				0.f, static_cast<float>(m_window->getHeight()),
-				1.f, -1.f);
-		m_defaultShader->setUniformMatrix("u_projection", *projection);
+		m_defaultTransform = m_defaultShader->uniformAdd("u_transform", Renderer::UniformType::MAT4);
+		m_defaultShader->uniformAdd("u_textures", Renderer::UniformType::INT_ARR);
+
+		// batches can sample from every texture unit the default shader has
+		GLint max_texture_units = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_texture_units);
+		unsigned int texture_unit_count = max_texture_units > 0 ? static_cast<unsigned int>(max_texture_units) : 1;
+		m_textureSlotCount = texture_unit_count < MAX_TEXTURE_SLOTS ? texture_unit_count : MAX_TEXTURE_SLOTS;
+
+		int texture_units[MAX_TEXTURE_SLOTS];
+		for(unsigned int i=0;i<MAX_TEXTURE_SLOTS;++i)
+			texture_units[i] = i < m_textureSlotCount ? static_cast<int>(i) : 0;
+		m_defaultShader->setUniformInt("u_textures", MAX_TEXTURE_SLOTS, texture_units);
+
+		m_defaultShader->setUniformMat4(m_defaultTransform, *Renderer::Mat4<float>());
+
+		// the projection and the rest of the frame block are shared by every shader
+		m_frameBuffer.create(m_window->getState(), sizeof(FrameBlock));
+		m_frameBuffer.bind(FRAME_BLOCK_BINDING);
+		m_startTime = glfwGetTime();
+		m_frameBlock.time = 0.f;
+		m_frameBlock.padding = 0.f;
+		updateFrameBlock(static_cast<float>(m_window->getWidth()), static_cast<float>(m_window->getHeight()));
+		bindFrameBlock(*m_defaultShader);
+
+		// instanced sprites sample the same texture slots as the default shader
+		m_instanceShader->vertexAttribAdd(0, Renderer::AttribType::VEC4, 1);
+		m_instanceShader->vertexAttribAdd(1, Renderer::AttribType::VEC3, 1);
+		m_instanceShader->vertexAttribAdd(2, Renderer::AttribType::VEC4, 1);
+		m_instanceShader->vertexAttribAdd(3, Renderer::AttribType::INT, 1);
+		m_instanceShader->vertexAttribAdd(4, Renderer::AttribType::INT, 1);
+		m_instanceShader->vertexAttribsEnable();
+		m_instanceShader->uniformAdd("u_textures", Renderer::UniformType::INT_ARR);
+		m_instanceShader->setUniformInt("u_textures", MAX_TEXTURE_SLOTS, texture_units);
+		bindFrameBlock(*m_instanceShader);
+
+		// keeps the driver from finishing the programs in the middle of the first frame
+		shader_compiler.wait();
+		shader_compiler.warmUp();
 
 		// default texture
 		unsigned char default_texture_data[] = {255, 255, 255};
 		m_whiteTexture = new Renderer::Texture(8);
 		m_whiteTexture->create(m_window, 1, 1, 3, default_texture_data);
 
+		// enough quad indices to fill a whole batch of default vertices
+		reserveQuadIndices(m_vertexBatchSize / (4 * m_defaultShader->getVertexBitSize()));
+
 		bindTexture(m_whiteTexture, 0);
+
+		// the instance shader and the warm up left other programs bound
+		m_defaultShader->bind();
 	}
 
 	void Render::setBlendMode(BlendMode blendMode)
 	{
+		if(m_deferred)
+		{
+			m_blendMode = blendMode;
+			return;
+		}
+
+		// the batch so far is drawn with the blend mode it was made with
+		if(blendMode != m_blendMode)
+			flush(FlushReason::BLEND_MODE_CHANGE);
+		m_blendMode = blendMode;
+
+		Renderer::GLState& state = m_window->getState();
 		switch(blendMode)
 		{
 			case BlendMode::BLEND:
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-				glBlendEquation(GL_FUNC_ADD);
+				state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				state.blendEquation(GL_FUNC_ADD);
 				break;
 			case BlendMode::MULTIPLY:
-				glBlendFunc(GL_DST_COLOR, GL_ZERO);
-				glBlendEquation(GL_FUNC_ADD);
+				state.blendFunc(GL_DST_COLOR, GL_ZERO);
+				state.blendEquation(GL_FUNC_ADD);
 				break;
 			case BlendMode::ADD:
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-				glBlendEquation(GL_FUNC_ADD);
+				state.blendFunc(GL_SRC_ALPHA, GL_ONE);
+				state.blendEquation(GL_FUNC_ADD);
 				break;
 			case BlendMode::SUBTRACT:
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-				glBlendEquation(GL_FUNC_SUBTRACT);
+				state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				state.blendEquation(GL_FUNC_SUBTRACT);
 				break;
 			case BlendMode::REPLACE:
-				glBlendFunc(GL_ONE, GL_ZERO);
-				glBlendEquation(GL_FUNC_ADD);
+				state.blendFunc(GL_ONE, GL_ZERO);
+				state.blendEquation(GL_FUNC_ADD);
 				break;
 			case BlendMode::IFEMPTY:
-				glBlendFunc(GL_ZERO, GL_ONE);
-				glBlendEquation(GL_FUNC_ADD);
+				state.blendFunc(GL_ZERO, GL_ONE);
+				state.blendEquation(GL_FUNC_ADD);
 				break;
 			case BlendMode::MIN:
-				glBlendFunc(GL_ONE, GL_ONE);
-				glBlendEquation(GL_MIN);
+				state.blendFunc(GL_ONE, GL_ONE);
+				state.blendEquation(GL_MIN);
 				break;
 			case BlendMode::MAX:
-				glBlendFunc(GL_ONE, GL_ONE);
-				glBlendEquation(GL_MAX);
+				state.blendFunc(GL_ONE, GL_ONE);
+				state.blendEquation(GL_MAX);
 				break;
 		}
 	}
 
+	void Render::setScissor(int _x, int _y, int _width, int _height)
+	{
+		// the renderer counts y from the top, gl from the bottom
+		Renderer::GLState& state = m_window->getState();
+		int bottom = static_cast<int>(m_viewportHeight) - _y - _height;
+
+		const GLint* scissor = state.getScissor();
+		if(state.isScissorTest() && scissor[0] == _x && scissor[1] == bottom && scissor[2] == _width && scissor[3] == _height)
+			return;
+
+		// deferred commands recorded so far are drawn with the old rectangle too
+		flush(FlushReason::SCISSOR_CHANGE);
+		state.scissor(_x, bottom, _width, _height);
+		state.scissorTest(true);
+	}
+
+	void Render::clearScissor()
+	{
+		Renderer::GLState& state = m_window->getState();
+		if(!state.isScissorTest())
+			return;
+
+		flush(FlushReason::SCISSOR_CHANGE);
+		state.scissorTest(false);
+	}
+
+	void Render::resetStats()
+	{
+		m_stats = RenderStats();
+		if(m_window)
+			m_window->getState().resetCounters();
+	}
+
+	void Render::setDeferred(bool _deferred)
+	{
+		if(m_deferred == _deferred)
+			return;
+
+		// draw everything recorded or batched in the previous mode first
+		flush(FlushReason::MODE_CHANGE);
+		m_deferred = _deferred;
+
+		m_recordShader = Renderer::Shader::getCurrentShader() ? Renderer::Shader::getCurrentShader() : m_defaultShader;
+		m_recordTexture = m_textureSlots[0];
+	}
+
 	void Render::bindShader(Renderer::Shader* _shader)
 	{
 		Renderer::Shader* bind_shader = _shader ? _shader : m_defaultShader;
+		if(m_deferred)
+		{
+			m_recordShader = bind_shader;
+			return;
+		}
+
 		if(bind_shader->isBound())
 			return;
 
-		render();
+		flush(FlushReason::SHADER_CHANGE);
 		bind_shader->bind();
 	}
 
 	void Render::bindTexture(Renderer::Texture* _texture, unsigned int _slot)
 	{
 		Renderer::Texture* bind_texture = _texture ? _texture : m_whiteTexture;
+		if(m_deferred)
+		{
+			if(_slot != 0)
+				throw Renderer::RenderingException("Deferred shapes can only use the texture bound to slot 0!");
+
+			m_recordTexture = bind_texture;
+			return;
+		}
 
 		if(bind_texture->isBound(_slot))
 			return;
 
-		render();
+		flush(FlushReason::TEXTURE_CHANGE);
 		bind_texture->bind(_slot);
+
+		// keep the slot from being handed out to another texture in this batch
+		if(_slot < MAX_TEXTURE_SLOTS)
+		{
+			m_textureSlots[_slot] = bind_texture;
+			if(m_textureSlotsUsed <= _slot)
+				m_textureSlotsUsed = _slot + 1;
+		}
+	}
+
+	unsigned int Render::batchTexture(Renderer::Texture* _texture)
+	{
+		Renderer::Texture* bind_texture = _texture ? _texture : m_whiteTexture;
+
+		// already bound for this batch
+		for(unsigned int i=0;i<m_textureSlotsUsed;++i)
+		{
+			if(m_textureSlots[i] != bind_texture)
+				continue;
+
+			if(!bind_texture->isBound(i))
+				bind_texture->bind(i);
+
+			return i;
+		}
+
+		// every slot is taken by the batch, draw it before reusing them
+		if(m_textureSlotsUsed >= m_textureSlotCount)
+		{
+			flush(FlushReason::TEXTURE_SLOTS_FULL);
+			m_textureSlotsUsed = 0;
+		}
+
+		unsigned int slot = m_textureSlotsUsed ++;
+		if(!bind_texture->isBound(slot))
+			bind_texture->bind(slot);
+
+		m_textureSlots[slot] = bind_texture;
+		return slot;
 	}
 
 	void Render::setColor(const Renderer::Color& _color)
@@ -196,129 +439,286 @@ namespace Renderer
 
 	void Render::drawImage(Renderer::Texture& _texture, int _x, int _y, int _width, int _height, const RectStyle& _style)
 	{
-		// calculate the alignment
-		float vertical_align = _style.verticalAlignAmount;
-		float horizontal_align = _style.horizontalAlignAmount;
-		switch(_style.verticalAlign)
+		Renderer::Sprite sprite = Renderer::rectSprite(&_texture, _x, _y, _width, _height, _style);
+
+		// unrotated rectangles need no trig at all, rotated ones reuse it while the angle stays the same
+		float sin_ang = 0.f;
+		float cos_ang = 1.f;
+		if(_style.angle != 0.f)
+			m_angleCache.sinCos(_style.angle, sin_ang, cos_ang);
+
+		// nothing is written or recorded for sprites outside of the window
+		if(m_culling && !m_customProjection && !Renderer::spriteVisible(sprite, sin_ang, cos_ang, m_viewportWidth, m_viewportHeight))
 		{
-			case VerticalAlign::TOP:
-				vertical_align = 0;
-				break;
-			case VerticalAlign::CENTER:
-				vertical_align = _height / 2;
-				break;
-			case VerticalAlign::BOTTOM:
-				vertical_align = _height;
-				break;
-			default:
-				break;
+			RENDERER_STAT(m_stats.culled += 1);
+			return;
 		}
 
-		switch(_style.horizontalAlign)
+		// recorded as a sprite, the same vertices are made when it is replayed
+		if(m_deferred)
 		{
-			case HorizontalAlign::LEFT:
-				horizontal_align = 0;
-				break;
-			case HorizontalAlign::CENTER:
-				horizontal_align = _width / 2;
-				break;
-			case HorizontalAlign::RIGHT:
-				horizontal_align = _width;
-				break;
-			default:
-				break;
+			m_commandBuffer.recordSprite(sprite, m_layer, m_blendMode);
+			return;
 		}
 
-		// create the vertices
-		float vertices[] = {
-			-horizontal_align, -vertical_align, // top left
-			-horizontal_align, -vertical_align + _height, // bottom left
-			-horizontal_align + _width, -vertical_align + _height, // bottom right
-			-horizontal_align + _width, -vertical_align // top right
-		};
+		if(m_instancing)
+		{
+			drawSpriteInstances(&sprite, 1);
+			return;
+		}
+
+		// top left, bottom left, bottom right, top right
+		float vertices[8];
+		Renderer::spriteCorners(sprite, sin_ang, cos_ang, vertices);
 
-		// rotate the vertices, then add the _x and _y
-		float cos_ang = std::cos(_style.angle);
-		float sin_ang = std::sin(_style.angle);
+		// draw the shape
+		bindShader(m_defaultShader);
+		int16_t texture_slot = static_cast<int16_t>(batchTexture(&_texture));
+
+		uint8_t col_r = Renderer::Pack::channel(_style.color.red);
+		uint8_t col_g = Renderer::Pack::channel(_style.color.green);
+		uint8_t col_b = Renderer::Pack::channel(_style.color.blue);
+		uint8_t col_a = Renderer::Pack::channel(_style.color.alpha);
+
+		Renderer::VertexWriter<Renderer::DefaultVertex> writer = beginShape<Renderer::DefaultVertex>(Renderer::DrawType::QUAD, 4);
+		writer.vertex({ vertices[0], vertices[1], col_r, col_g, col_b, col_a, 0, 65535, texture_slot, 0 });
+		writer.vertex({ vertices[2], vertices[3], col_r, col_g, col_b, col_a, 0, 0, texture_slot, 0 });
+		writer.vertex({ vertices[4], vertices[5], col_r, col_g, col_b, col_a, 65535, 0, texture_slot, 0 });
+		writer.vertex({ vertices[6], vertices[7], col_r, col_g, col_b, col_a, 65535, 65535, texture_slot, 0 });
+		endShape();
 
-		for(int i=0;i<4;++i)
+		RENDERER_STAT(m_stats.sprites += 1);
+	}
+
+	void Render::drawSprites(const Renderer::Sprite* _sprites, size_t _count)
+	{
+		if(m_deferred)
 		{
-			float x = vertices[i * 2];
-			float y = vertices[i * 2 + 1];
-			vertices[i * 2] = cos_ang * x - sin_ang * y + _x;
-			vertices[i * 2 + 1] = sin_ang * x + cos_ang * y + _y;
+			for(size_t i=0;i<_count;++i)
+				m_commandBuffer.recordSprite(_sprites[i], m_layer, m_blendMode);
+			return;
+		}
+
+		if(m_instancing)
+		{
+			drawSpriteInstances(_sprites, _count);
+			return;
 		}
 
-		// draw the shape
-		bindTexture(&_texture, 0);
 		bindShader(m_defaultShader);
 
-		float col_r = _style.color.red / 255.f;
-		float col_g = _style.color.green / 255.f;
-		float col_b = _style.color.blue / 255.f;
-		float col_a = _style.color.alpha / 255.f;
-
-		beginShape(Renderer::DrawType::TRIANGLE, 4, 0);
-		vertex2f(vertices[0], vertices[1]);
-		vertex4f(col_r, col_g, col_b, col_a);
-		vertex2f(0.f, 1.f);
-		nextVertex();
-		vertex2f(vertices[2], vertices[3]);
-		vertex4f(col_r, col_g, col_b, col_a);
-		vertex2f(0.f, 0.f);
-		nextVertex();
-		vertex2f(vertices[4], vertices[5]);
-		vertex4f(col_r, col_g, col_b, col_a);
-		vertex2f(1.f, 0.f);
-		nextVertex();
-		vertex2f(vertices[6], vertices[7]);
-		vertex4f(col_r, col_g, col_b, col_a);
-		vertex2f(1.f, 1.f);
-		endShape();
+		unsigned int sprite_bytes = 4 * m_defaultShader->getVertexBitSize();
+		if(sprite_bytes >= m_vertexBatchSize)
+		{
+			flush(FlushReason::BATCH_FULL);
+			fitBatches(sprite_bytes + 1, 0);
+		}
+
+		size_t sprite_index = 0;
+		while(sprite_index < _count)
+		{
+			// consecutive sprites with the same texture are written in one go
+			Renderer::Texture* texture = _sprites[sprite_index].texture ? _sprites[sprite_index].texture : m_whiteTexture;
+			size_t run_end = sprite_index + 1;
+			while(run_end < _count && (_sprites[run_end].texture ? _sprites[run_end].texture : m_whiteTexture) == texture)
+				++ run_end;
+
+			int texture_slot = static_cast<int>(batchTexture(texture));
+			if(m_currentDrawType != DrawType::QUAD)
+				flush(FlushReason::DRAW_TYPE_CHANGE); // flush all the other shapes first
+
+			m_currentDrawType = DrawType::QUAD;
+
+			while(sprite_index < run_end)
+			{
+				size_t batch_room = (m_vertexBatchSize - m_verticesTracker - 1) / sprite_bytes;
+				if(batch_room == 0)
+				{
+					++ m_vertexOverflows;
+					flush(FlushReason::BATCH_FULL);
+					continue;
+				}
+
+				size_t sprite_count = run_end - sprite_index < batch_room ? run_end - sprite_index : batch_room;
+				Renderer::spriteVertices(_sprites + sprite_index, sprite_count, texture_slot,
+						reinterpret_cast<Renderer::DefaultVertex*>(m_verticesBatch + m_verticesTracker));
+
+				m_verticesTracker += sprite_count * sprite_bytes;
+				sprite_index += sprite_count;
+				RENDERER_STAT(m_stats.sprites += sprite_count);
+			}
+		}
+	}
+
+	void Render::drawRecordedSprites(const unsigned int* _indices, size_t _count)
+	{
+		// instances are cheap to make, the recorded sprites go through the usual path
+		if(m_instancing)
+		{
+			std::vector<Renderer::Sprite> sprites(_count);
+			for(size_t i=0;i<_count;++i)
+				sprites[i] = m_commandBuffer.getSprite(_indices[i]);
+
+			drawSpriteInstances(sprites.data(), sprites.size());
+			return;
+		}
+
+		bindShader(m_defaultShader);
+
+		unsigned int sprite_bytes = 4 * m_defaultShader->getVertexBitSize();
+		if(sprite_bytes >= m_vertexBatchSize)
+		{
+			flush(FlushReason::BATCH_FULL);
+			fitBatches(sprite_bytes + 1, 0);
+		}
+
+		// the vertices were made while recording, only the texture slot is left to fill in
+		for(size_t i=0;i<_count;++i)
+		{
+			const Renderer::Sprite& sprite = m_commandBuffer.getSprite(_indices[i]);
+			int16_t texture_slot = static_cast<int16_t>(batchTexture(sprite.texture ? sprite.texture : m_whiteTexture));
+			if(m_currentDrawType != DrawType::QUAD)
+				flush(FlushReason::DRAW_TYPE_CHANGE); // flush all the other shapes first
+
+			m_currentDrawType = DrawType::QUAD;
+
+			if(m_verticesTracker + sprite_bytes >= m_vertexBatchSize)
+			{
+				++ m_vertexOverflows;
+				flush(FlushReason::BATCH_FULL);
+			}
+
+			Renderer::DefaultVertex* vertices = reinterpret_cast<Renderer::DefaultVertex*>(m_verticesBatch + m_verticesTracker);
+			memcpy(vertices, m_commandBuffer.getSpriteVertices(_indices[i]), sprite_bytes);
+			for(int j=0;j<4;++j)
+				vertices[j].textureSlot = texture_slot;
+
+			m_verticesTracker += sprite_bytes;
+			RENDERER_STAT(m_stats.sprites += 1);
+		}
+	}
+
+	void Render::drawSpriteInstances(const Renderer::Sprite* _sprites, size_t _count)
+	{
+		bindShader(m_instanceShader);
+		if(m_currentDrawType != DrawType::QUAD)
+			flush(FlushReason::DRAW_TYPE_CHANGE); // flush all the other shapes first
+
+		if(sizeof(Renderer::SpriteInstance) >= m_vertexBatchSize)
+		{
+			flush(FlushReason::BATCH_FULL);
+			fitBatches(sizeof(Renderer::SpriteInstance) + 1, 0);
+		}
+
+		m_currentDrawType = DrawType::QUAD;
+
+		size_t sprite_index = 0;
+		while(sprite_index < _count)
+		{
+			// consecutive sprites with the same texture are written in one go
+			Renderer::Texture* texture = _sprites[sprite_index].texture ? _sprites[sprite_index].texture : m_whiteTexture;
+			size_t run_end = sprite_index + 1;
+			while(run_end < _count && (_sprites[run_end].texture ? _sprites[run_end].texture : m_whiteTexture) == texture)
+				++ run_end;
+
+			int texture_slot = static_cast<int>(batchTexture(texture));
+			while(sprite_index < run_end)
+			{
+				size_t batch_room = (m_vertexBatchSize - m_verticesTracker - 1) / sizeof(Renderer::SpriteInstance);
+				if(batch_room == 0)
+				{
+					++ m_vertexOverflows;
+					flush(FlushReason::BATCH_FULL);
+					continue;
+				}
+
+				size_t sprite_count = run_end - sprite_index < batch_room ? run_end - sprite_index : batch_room;
+				Renderer::spriteInstances(_sprites + sprite_index, sprite_count, texture_slot,
+						reinterpret_cast<Renderer::SpriteInstance*>(m_verticesBatch + m_verticesTracker));
+
+				m_verticesTracker += sprite_count * sizeof(Renderer::SpriteInstance);
+				sprite_index += sprite_count;
+				RENDERER_STAT(m_stats.sprites += sprite_count);
+			}
+		}
 	}
 
 	void Render::beginShape(DrawType _type, unsigned int _vertexCount, unsigned int _indicesCount)
 	{
-		if(Renderer::Shader::getCurrentShader()->getWindow() != m_window)
+		// a deleted shader leaves nothing bound, shapes then use the default shader
+		if(!m_deferred && !Renderer::Shader::getCurrentShader())
+			bindShader(m_defaultShader);
+
+		Renderer::Shader* shape_shader = m_deferred ? m_recordShader : Renderer::Shader::getCurrentShader();
+		if(shape_shader->getWindow() != m_window)
 			throw Renderer::RenderingException("The currently bound shader is not for this window context!");
 
 		if(_type == DrawType::NONE)
 			return;
 
-		if(Renderer::Shader::getCurrentShader()->getVertexBitSize() * _vertexCount >= m_vertexBatchSize)
-			throw Renderer::RenderingException("The shape is too large. Consider splitting it up or changing the vertex batch size!");
+		if(_type == DrawType::QUAD && _vertexCount % 4 != 0)
+			throw Renderer::RenderingException("Quads must be made of 4 vertices each!");
+
+		unsigned int shape_bytes = shape_shader->getVertexBitSize() * _vertexCount;
+
+		m_shapeDrawType = _type;
+		m_shapeVertexTracker = _vertexCount;
+		m_shapeVertexSize = shape_shader->getVertexBitSize();
+		m_shapeVertexBytesLeft = m_shapeVertexSize;
+
+		// record the shape to be sorted and batched in render()
+		if(m_deferred)
+		{
+			m_shapeIndexCount = _indicesCount > 0 ? _indicesCount : defaultIndexCount(_type, _vertexCount);
+			m_shapeWrite = m_commandBuffer.recordShape(m_recordShader, m_recordTexture, _type, _vertexCount,
+					_indicesCount, m_layer, m_blendMode);
+			return;
+		}
+
+		// quads join a pending triangle batch with regular indices rather than flushing it
+		DrawType batch_type = _type;
+		if(_type == DrawType::QUAD && m_currentDrawType == DrawType::TRIANGLE && m_indicesTracker > 0)
+			batch_type = DrawType::TRIANGLE;
 
-		if(m_currentDrawType != _type)
-			render(); // flush all the other shapes first
+		if(m_currentDrawType != batch_type)
+			flush(FlushReason::DRAW_TYPE_CHANGE); // flush all the other shapes first
 
-		unsigned int shape_bytes = Renderer::Shader::getCurrentShader()->getVertexBitSize() * _vertexCount;
 		if(m_verticesTracker + shape_bytes >= m_vertexBatchSize)
-			render(); // flush all the other shapes first
+		{
+			++ m_vertexOverflows;
+			flush(FlushReason::BATCH_FULL); // flush all the other shapes first
+		}
 
 		// calculate default number of indices
-		if(_indicesCount == 0)
+		if(_type == DrawType::QUAD)
+			_indicesCount = batch_type == DrawType::QUAD ? 0 : defaultIndexCount(DrawType::QUAD, _vertexCount);
+		else if(_indicesCount == 0)
+			_indicesCount = defaultIndexCount(_type, _vertexCount);
+
+		// one more index to restart the strip when it follows another one
+		unsigned int restart_count = isStripType(batch_type) ? 1 : 0;
+		if(m_indicesTracker + _indicesCount + restart_count >= m_indexBatchSize)
 		{
-			switch(_type)
-			{
-				case DrawType::TRIANGLE:
-					_indicesCount = 3 * (_vertexCount - 2);
-					break;
-				default:
-					_indicesCount = _vertexCount;
-					break;
-			}
+			++ m_indexOverflows;
+			flush(FlushReason::BATCH_FULL); // flush all the other shapes first
 		}
 
-		if(m_indicesTracker + _indicesCount >= m_indexBatchSize)
-			render(); // flush all the other shapes first
+		// a shape larger than a whole batch gets a batch that fits it and anything still pending
+		if(m_verticesTracker + shape_bytes >= m_vertexBatchSize
+				|| m_indicesTracker + _indicesCount + restart_count >= m_indexBatchSize)
+		{
+			fitBatches(m_verticesTracker + shape_bytes + 1, m_indicesTracker + _indicesCount + restart_count + 1);
+		}
 
 		// setup variables for the upcoming shape
-		m_currentDrawType = _type;
-
+		m_currentDrawType = batch_type;
 		m_shapeIndexCount = _indicesCount;
-		m_shapeVertexTracker = _vertexCount;
-		m_shapeVertexBytesLeft = Renderer::Shader::getCurrentShader()->getVertexBitSize();
-		m_startOfShapeVertexTracker = m_verticesTracker / m_shapeVertexBytesLeft;
+		m_shapeRestart = restart_count > 0 && m_indicesTracker > 0;
+		m_startOfShapeVertexTracker = m_verticesTracker / m_shapeVertexSize;
+
+		// the vertices are written in place, the batch keeps the room for them
+		m_shapeWrite = m_verticesBatch + m_verticesTracker;
+		m_verticesTracker += shape_bytes;
 	}
 
 	void Render::nextVertex()
@@ -330,137 +730,214 @@ namespace Renderer
 			throw Renderer::RenderingException("Not enough bytes are passed in for the previous vertex!");
 
 		-- m_shapeVertexTracker;
-		m_shapeVertexBytesLeft = Renderer::Shader::getCurrentShader()->getVertexBitSize();
+		m_shapeVertexBytesLeft = m_shapeVertexSize;
 	}
 
 	void Render::endShape(const unsigned int* _indices)
 	{
-		if(m_shapeVertexTracker > 1)
-			throw Renderer::RenderingException("Too few vertices are passed in! Please call beginShape() with the correct number of vertices!");
-		if(m_shapeVertexTracker < 1)
-			throw Renderer::RenderingException("Too many vertices are passed in! Please call beginShape() with the correct number of vertices!");
+		assertShapeComplete();
 
-		if(m_shapeVertexBytesLeft > 0)
-			throw Renderer::RenderingException("Not enough bytes are passed in for the last vertex!");
+		if(m_deferred)
+		{
+			m_commandBuffer.recordShapeIndices(_indices, m_shapeIndexCount);
+			return;
+		}
+
+		if(m_shapeRestart)
+			m_indicesBatch[m_indicesTracker ++] = PRIMITIVE_RESTART_INDEX;
 
 		memcpy(m_indicesBatch + m_indicesTracker, _indices, sizeof(unsigned int) * m_shapeIndexCount);
 		for(int i=0;i<m_shapeIndexCount;++i)
-			m_indicesBatch[m_indicesTracker + i] += m_startOfShapeVertexTracker;
+		{
+			if(m_indicesBatch[m_indicesTracker + i] != PRIMITIVE_RESTART_INDEX)
+				m_indicesBatch[m_indicesTracker + i] += m_startOfShapeVertexTracker;
+		}
 
 		m_indicesTracker += m_shapeIndexCount;
 	}
 
 	void Render::endShape()
 	{
-		unsigned int* calculate_indices = new unsigned int[m_shapeIndexCount];
+		assertShapeComplete();
 
+		// recorded shapes get their indices when they are replayed
+		if(m_deferred)
+			return;
+
+		if(m_shapeRestart)
+			m_indicesBatch[m_indicesTracker ++] = PRIMITIVE_RESTART_INDEX;
+
+		unsigned int* shape_indices = m_indicesBatch + m_indicesTracker;
+		unsigned int first_vertex = m_startOfShapeVertexTracker;
+
+		// quads in a quad batch use the prebuilt index buffer
+		if(m_shapeIndexCount == 0)
+			return;
+
+		// quads sharing a batch with other triangles
+		if(m_shapeDrawType == DrawType::QUAD)
+		{
+			for(unsigned int i=0;i<m_shapeIndexCount / 6;++i)
+			{
+				unsigned int quad_vertex = first_vertex + 4 * i;
+				shape_indices[6 * i    ] = quad_vertex;
+				shape_indices[6 * i + 1] = quad_vertex + 1;
+				shape_indices[6 * i + 2] = quad_vertex + 2;
+				shape_indices[6 * i + 3] = quad_vertex;
+				shape_indices[6 * i + 4] = quad_vertex + 2;
+				shape_indices[6 * i + 5] = quad_vertex + 3;
+			}
+		}
 		// for triangles (which are used for drawing polygons)
-		if(m_currentDrawType == DrawType::TRIANGLE)
+		else if(m_currentDrawType == DrawType::TRIANGLE)
 		{
 			for(unsigned int i=0;i<m_shapeIndexCount / 3;++i)
 			{
-				calculate_indices[3 * i    ] = 0;
-				calculate_indices[3 * i + 1] = 1 + i;
-				calculate_indices[3 * i + 2] = 2 + i;
+				shape_indices[3 * i    ] = first_vertex;
+				shape_indices[3 * i + 1] = first_vertex + 1 + i;
+				shape_indices[3 * i + 2] = first_vertex + 2 + i;
 			}
-			endShape(calculate_indices);
-
-			delete[] calculate_indices;
-			return;
 		}
-
 		// for every other draw types
-		for(unsigned int i=0;i<m_shapeIndexCount;++i)
-			calculate_indices[i] = i;
+		else
+		{
+			for(unsigned int i=0;i<m_shapeIndexCount;++i)
+				shape_indices[i] = first_vertex + i;
+		}
 
-		endShape(calculate_indices);
-		delete[] calculate_indices;
-		return;
+		m_indicesTracker += m_shapeIndexCount;
 	}
 
 	void Render::vertex1f(float _v)
 	{
-		assertShapeVertexSafeToStore(sizeof(float));
-		memcpy(m_verticesBatch + m_verticesTracker, &_v, sizeof(float));
-		m_verticesTracker += sizeof(float);
+		storeShapeData(&_v, sizeof(float));
 	}
 
 	void Render::vertex2f(float _v0, float _v1)
 	{
-		assertShapeVertexSafeToStore(sizeof(float) * 2);
-		memcpy(m_verticesBatch + m_verticesTracker, &_v0, sizeof(float));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(float), &_v1, sizeof(float));
-
-		m_verticesTracker += sizeof(float) * 2;
+		float data[] = { _v0, _v1 };
+		storeShapeData(data, sizeof(data));
 	}
 
 	void Render::vertex3f(float _v0, float _v1, float _v2)
 	{
-		assertShapeVertexSafeToStore(sizeof(float) * 3);
-		memcpy(m_verticesBatch + m_verticesTracker, &_v0, sizeof(float));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(float), &_v1, sizeof(float));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(float) * 2, &_v2, sizeof(float));
-
-		m_verticesTracker += sizeof(float) * 3;
+		float data[] = { _v0, _v1, _v2 };
+		storeShapeData(data, sizeof(data));
 	}
 
 	void Render::vertex4f(float _v0, float _v1, float _v2, float _v3)
 	{
-		assertShapeVertexSafeToStore(sizeof(float) * 4);
-		memcpy(m_verticesBatch + m_verticesTracker, &_v0, sizeof(float));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(float), &_v1, sizeof(float));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(float) * 2, &_v2, sizeof(float));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(float) * 3, &_v3, sizeof(float));
-		m_verticesTracker += sizeof(float) * 4;
+		float data[] = { _v0, _v1, _v2, _v3 };
+		storeShapeData(data, sizeof(data));
 	}
 
 	void Render::vertex1i(int _v)
 	{
-		assertShapeVertexSafeToStore(sizeof(int));
-		memcpy(m_verticesBatch + m_verticesTracker, &_v, sizeof(int));
-		m_verticesTracker += sizeof(int);
+		storeShapeData(&_v, sizeof(int));
 	}
 
 	void Render::vertex2i(int _v0, int _v1)
 	{
-		assertShapeVertexSafeToStore(sizeof(int) * 2);
-		memcpy(m_verticesBatch + m_verticesTracker, &_v0, sizeof(int));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(int), &_v1, sizeof(int));
-		m_verticesTracker += sizeof(int) * 2;
+		int data[] = { _v0, _v1 };
+		storeShapeData(data, sizeof(data));
 	}
 
 	void Render::vertex3i(int _v0, int _v1, int _v2)
 	{
-		assertShapeVertexSafeToStore(sizeof(int) * 3);
-		memcpy(m_verticesBatch + m_verticesTracker, &_v0, sizeof(int));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(int), &_v1, sizeof(int));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(int) * 2, &_v2, sizeof(int));
-		m_verticesTracker += sizeof(int) * 3;
+		int data[] = { _v0, _v1, _v2 };
+		storeShapeData(data, sizeof(data));
 	}
 
 	void Render::vertex4i(int _v0, int _v1, int _v2, int _v3)
 	{
-		assertShapeVertexSafeToStore(sizeof(int) * 4);
-		memcpy(m_verticesBatch + m_verticesTracker, &_v0, sizeof(int));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(int), &_v1, sizeof(int));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(int) * 2, &_v2, sizeof(int));
-		memcpy(m_verticesBatch + m_verticesTracker + sizeof(int) * 3, &_v3, sizeof(int));
-		m_verticesTracker += sizeof(int) * 4;
+		int data[] = { _v0, _v1, _v2, _v3 };
+		storeShapeData(data, sizeof(data));
+	}
+
+	void Render::vertex4ub(uint8_t _v0, uint8_t _v1, uint8_t _v2, uint8_t _v3)
+	{
+		uint8_t data[] = { _v0, _v1, _v2, _v3 };
+		storeShapeData(data, sizeof(data));
+	}
+
+	void Render::vertexColor(const Renderer::Color& _color)
+	{
+		vertex4ub(Renderer::Pack::channel(_color.red), Renderer::Pack::channel(_color.green),
+				Renderer::Pack::channel(_color.blue), Renderer::Pack::channel(_color.alpha));
+	}
+
+	void Render::vertex2h(float _v0, float _v1)
+	{
+		uint16_t data[] = { Renderer::Pack::half(_v0), Renderer::Pack::half(_v1) };
+		storeShapeData(data, sizeof(data));
+	}
+
+	void Render::vertex2s(int16_t _v0, int16_t _v1)
+	{
+		int16_t data[] = { _v0, _v1 };
+		storeShapeData(data, sizeof(data));
+	}
+
+	void Render::vertex2us(uint16_t _v0, uint16_t _v1)
+	{
+		uint16_t data[] = { _v0, _v1 };
+		storeShapeData(data, sizeof(data));
+	}
+
+	void Render::vertex2unorm(float _v0, float _v1)
+	{
+		vertex2us(Renderer::Pack::unorm16(_v0), Renderer::Pack::unorm16(_v1));
+	}
+
+	void Render::storeShapeData(const void* _data, unsigned int _bytes)
+	{
+		assertShapeVertexSafeToStore(_bytes);
+		memcpy(m_shapeWrite, _data, _bytes);
+		m_shapeWrite += _bytes;
 	}
 
 	void Render::render()
 	{
+		flush(FlushReason::EXPLICIT);
+
+		// the next frame sees the time it starts at
+		m_frameBlock.time = static_cast<float>(glfwGetTime() - m_startTime);
+		m_frameBuffer.bind(FRAME_BLOCK_BINDING);
+		m_frameBuffer.data(&m_frameBlock, sizeof(FrameBlock));
+
+		// every explicit render() ends a frame for the batch sizing
+		if(m_adaptiveBatching)
+			adaptBatches();
+	}
+
+	void Render::flush(FlushReason _reason)
+	{
+		if(m_deferred)
+			replayCommands();
+
+		if(m_verticesTracker > m_vertexHighWater)
+			m_vertexHighWater = m_verticesTracker;
+		if(m_indicesTracker > m_indexHighWater)
+			m_indexHighWater = m_indicesTracker;
+
+		// whatever is not drawn now is dropped, a later shape is written after the trackers
 		Renderer::Shader* current_shader = Renderer::Shader::getCurrentShader();
-		if(current_shader->getWindow() != m_window)
+		if(!current_shader || current_shader->getWindow() != m_window)
+		{
+			discardBatch();
 			return;
+		}
 
 		GLenum gl_draw_type;
+		unsigned int min_index_count = 3;
 		switch(m_currentDrawType)
 		{
 			case DrawType::POINTS:
 				gl_draw_type = GL_POINTS;
+				min_index_count = 1;
 				break;
 			case DrawType::TRIANGLE:
+			case DrawType::QUAD:
 				gl_draw_type = GL_TRIANGLES;
 				break;
 			case DrawType::TRIANGLE_STRIP:
@@ -471,28 +948,469 @@ namespace Renderer
 				break;
 			case DrawType::LINE:
 				gl_draw_type = GL_LINES;
+				min_index_count = 2;
 				break;
 			case DrawType::LINE_STRIP:
 				gl_draw_type = GL_LINE_STRIP;
+				min_index_count = 2;
 				break;
 			case DrawType::LINE_LOOP:
 				gl_draw_type = GL_LINE_LOOP;
+				min_index_count = 2;
 				break;
 			default:
+				discardBatch();
 				return;
 				break;
 		}
-		if(m_indicesTracker < 3)
+		unsigned int vertex_size = current_shader->getVertexBitSize();
+		if(vertex_size == 0)
+		{
+			discardBatch();
+			return;
+		}
+
+		if(current_shader == m_instanceShader)
+		{
+			renderInstances(_reason);
+			return;
+		}
+
+		// quads are drawn with the prebuilt index buffer and never store indices
+		unsigned int index_count = m_indicesTracker;
+		if(m_currentDrawType == DrawType::QUAD)
+		{
+			unsigned int quad_count = m_verticesTracker / vertex_size / 4;
+			reserveQuadIndices(quad_count);
+			index_count = 6 * quad_count;
+		}
+
+		if(index_count < min_index_count)
+		{
+			discardBatch();
 			return;
+		}
+
+		// the indices are relative to the batch, 16 bits are enough unless it has 65535 vertices or more
+		unsigned int vertex_count = m_verticesTracker / vertex_size;
+		bool short_indices = vertex_count < 0xFFFF;
+		unsigned int index_size = short_indices ? sizeof(uint16_t) : sizeof(unsigned int);
+
+		// vertices must start on a whole vertex for the base vertex, indices on a whole index
+		unsigned int index_bytes = index_size * m_indicesTracker;
+		unsigned int stream_offset = m_streamBuffer.reserve(m_verticesTracker + index_bytes + vertex_size + index_size);
+		unsigned int vertex_offset = (stream_offset + vertex_size - 1) / vertex_size * vertex_size;
+		unsigned int index_offset = (vertex_offset + m_verticesTracker + index_size - 1) / index_size * index_size;
+
+		unsigned char* stream_data = static_cast<unsigned char*>(m_streamBuffer.map(vertex_offset, index_offset + index_bytes - vertex_offset));
+		memcpy(stream_data, m_verticesBatch, m_verticesTracker);
+		if(short_indices)
+		{
+			// the restart index truncates to 0xFFFF
+			uint16_t* short_data = reinterpret_cast<uint16_t*>(stream_data + index_offset - vertex_offset);
+			for(unsigned int i=0;i<m_indicesTracker;++i)
+				short_data[i] = static_cast<uint16_t>(m_indicesBatch[i]);
+		} else
+			memcpy(stream_data + index_offset - vertex_offset, m_indicesBatch, index_bytes);
+		m_streamBuffer.unmap();
+
+		// the prebuilt quad indices stay 32 bit, they are never uploaded again
+		GLenum index_type = short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		if(m_currentDrawType == DrawType::QUAD)
+		{
+			current_shader->bindStreamBuffer(m_streamBuffer.getId(), m_quadIndexBuffer);
+			index_offset = 0;
+			index_type = GL_UNSIGNED_INT;
+		}
+		else
+			current_shader->bindStreamBuffer(m_streamBuffer.getId(), m_streamBuffer.getId());
+
+		// restart stays enabled, a 16 bit batch before would cut 32 bit batches at index 65535
+		setRestartIndex(index_type);
+
+		glDrawElementsBaseVertex(gl_draw_type, index_count, index_type,
+				(const void*)(uintptr_t)index_offset, vertex_offset / vertex_size);
+		m_streamBuffer.fence();
 
-		current_shader->verticesData(m_verticesBatch, sizeof(unsigned char) * m_verticesTracker);
-		current_shader->indicesData(m_indicesBatch, m_indicesTracker);
-		glDrawElements(gl_draw_type, m_indicesTracker, GL_UNSIGNED_INT, nullptr);
+		RENDERER_STAT(
+			m_stats.drawCalls += 1;
+			m_stats.vertices += m_verticesTracker / vertex_size;
+			m_stats.indices += index_count;
+			m_stats.bytesUploaded += m_verticesTracker + index_bytes;
+			m_stats.flushes[static_cast<int>(_reason)] += 1;
+		)
+
+		m_verticesTracker = 0;
+		m_indicesTracker = 0;
+	}
 
+	void Render::discardBatch()
+	{
 		m_verticesTracker = 0;
 		m_indicesTracker = 0;
 	}
 
+	BatchSizing Render::getBatchSizing() const
+	{
+		return {
+			m_vertexBatchSize, m_indexBatchSize, m_streamBuffer.getSize(),
+			m_totalOverflows + m_vertexOverflows + m_indexOverflows,
+			m_batchGrows, m_batchShrinks
+		};
+	}
+
+	void Render::adaptBatches()
+	{
+		unsigned int vertex_batch_size = m_vertexBatchSize;
+		unsigned int index_batch_size = m_indexBatchSize;
+
+		// batches overflowed this frame, double the ones that did
+		if(m_vertexOverflows > 0 || m_indexOverflows > 0)
+		{
+			if(m_vertexOverflows > 0 && vertex_batch_size <= MAX_VERTEX_BATCH_SIZE / 2)
+				vertex_batch_size *= 2;
+			if(m_indexOverflows > 0 && index_batch_size <= MAX_INDEX_BATCH_SIZE / 2)
+				index_batch_size *= 2;
+
+			m_quietFrames = 0;
+		}
+		// a quarter of the batch was enough for a while, halve it
+		else if(m_vertexHighWater < m_vertexBatchSize / 4 && m_indexHighWater < m_indexBatchSize / 4)
+		{
+			if(++ m_quietFrames >= SHRINK_COOLDOWN_FRAMES)
+			{
+				if(vertex_batch_size / 2 >= MIN_VERTEX_BATCH_SIZE)
+					vertex_batch_size /= 2;
+				if(index_batch_size / 2 >= MIN_INDEX_BATCH_SIZE)
+					index_batch_size /= 2;
+				m_quietFrames = 0;
+			}
+		} else
+			m_quietFrames = 0;
+
+		m_vertexHighWater = 0;
+		m_indexHighWater = 0;
+		m_totalOverflows += m_vertexOverflows + m_indexOverflows;
+		m_vertexOverflows = 0;
+		m_indexOverflows = 0;
+
+		if(vertex_batch_size == m_vertexBatchSize && index_batch_size == m_indexBatchSize)
+			return;
+
+		if(vertex_batch_size > m_vertexBatchSize || index_batch_size > m_indexBatchSize)
+			++ m_batchGrows;
+		else
+			++ m_batchShrinks;
+
+		resizeBatches(vertex_batch_size, index_batch_size);
+	}
+
+	void Render::fitBatches(unsigned int _vertexBytes, unsigned int _indexCount)
+	{
+		unsigned int vertex_batch_size = m_vertexBatchSize;
+		unsigned int index_batch_size = m_indexBatchSize;
+		while(vertex_batch_size < _vertexBytes)
+			vertex_batch_size = vertex_batch_size > 0 ? vertex_batch_size * 2 : 1;
+		while(index_batch_size < _indexCount)
+			index_batch_size = index_batch_size > 0 ? index_batch_size * 2 : 1;
+
+		++ m_batchGrows;
+		resizeBatches(vertex_batch_size, index_batch_size);
+	}
+
+	void Render::resizeBatches(unsigned int _vertexBatchSize, unsigned int _indexBatchSize)
+	{
+		// a batch that was not drawn moves along when it fits, it is dropped otherwise
+		if(m_verticesTracker > _vertexBatchSize || m_indicesTracker > _indexBatchSize)
+			discardBatch();
+
+		if(_vertexBatchSize != m_vertexBatchSize)
+		{
+			unsigned char* vertices_batch = new unsigned char[_vertexBatchSize];
+			memcpy(vertices_batch, m_verticesBatch, m_verticesTracker);
+			delete[] m_verticesBatch;
+			m_verticesBatch = vertices_batch;
+			m_vertexBatchSize = _vertexBatchSize;
+		}
+
+		if(_indexBatchSize != m_indexBatchSize)
+		{
+			unsigned int* indices_batch = new unsigned int[_indexBatchSize];
+			memcpy(indices_batch, m_indicesBatch, m_indicesTracker * sizeof(unsigned int));
+			delete[] m_indicesBatch;
+			m_indicesBatch = indices_batch;
+			m_indexBatchSize = _indexBatchSize;
+		}
+
+		// the stream buffer keeps at least the size it was constructed with
+		unsigned int stream_size = streamBufferSize(m_vertexBatchSize, m_indexBatchSize, m_requestedStreamSize);
+		if(stream_size != m_streamBuffer.getSize())
+			m_streamBuffer.resize(stream_size);
+	}
+
+	bool Render::bindFrameBlock(Renderer::Shader& _shader)
+	{
+		return _shader.uniformBlockBind("RendererFrame", FRAME_BLOCK_BINDING);
+	}
+
+	void Render::setProjection(const Renderer::Mat4<float>& _projection)
+	{
+		// the batch so far is drawn with the projection it was made for
+		flush(FlushReason::PROJECTION_CHANGE);
+
+		m_customProjection = true;
+		memcpy(m_frameBlock.projection, *_projection, sizeof(m_frameBlock.projection));
+		m_frameBuffer.data(&m_frameBlock, sizeof(FrameBlock));
+	}
+
+	void Render::resetProjection()
+	{
+		flush(FlushReason::PROJECTION_CHANGE);
+
+		m_customProjection = false;
+		updateFrameBlock(m_viewportWidth, m_viewportHeight);
+	}
+
+	void Render::updateFrameBlock(float _width, float _height)
+	{
+		m_viewportWidth = _width;
+		m_viewportHeight = _height;
+
+		// a projection set by the user is kept through resizes
+		if(!m_customProjection)
+		{
+			Renderer::Mat4<float> projection = Renderer::Math::projection2D(
+					0.f, _width,
+					0.f, _height,
+					1.f, -1.f);
+			memcpy(m_frameBlock.projection, *projection, sizeof(m_frameBlock.projection));
+		}
+		m_frameBlock.viewport[0] = _width;
+		m_frameBlock.viewport[1] = _height;
+
+		m_frameBuffer.data(&m_frameBlock, sizeof(FrameBlock));
+	}
+
+	void Render::setRestartIndex(GLenum _indexType)
+	{
+		// the restart index has to be the largest value of the index type being drawn
+		if(m_restartIndexType == _indexType)
+			return;
+
+		glPrimitiveRestartIndex(_indexType == GL_UNSIGNED_SHORT ? 0xFFFF : PRIMITIVE_RESTART_INDEX);
+		m_restartIndexType = _indexType;
+	}
+
+	void Render::renderInstances(FlushReason _reason)
+	{
+		unsigned int instance_count = m_verticesTracker / sizeof(Renderer::SpriteInstance);
+		if(instance_count == 0)
+		{
+			discardBatch();
+			return;
+		}
+
+		// the instances are read through the attribute offsets, which only need 4 byte alignment
+		unsigned int stream_offset = m_streamBuffer.reserve(m_verticesTracker + sizeof(unsigned int));
+		unsigned int instance_offset = (stream_offset + sizeof(unsigned int) - 1) / sizeof(unsigned int) * sizeof(unsigned int);
+
+		void* stream_data = m_streamBuffer.map(instance_offset, m_verticesTracker);
+		memcpy(stream_data, m_verticesBatch, m_verticesTracker);
+		m_streamBuffer.unmap();
+
+		m_instanceShader->bindStreamBuffer(m_streamBuffer.getId(), m_quadIndexBuffer, instance_offset);
+		glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr, instance_count);
+		m_streamBuffer.fence();
+
+		RENDERER_STAT(
+			m_stats.drawCalls += 1;
+			m_stats.instances += instance_count;
+			m_stats.vertices += 4 * instance_count;
+			m_stats.indices += 6 * instance_count;
+			m_stats.bytesUploaded += m_verticesTracker;
+			m_stats.flushes[static_cast<int>(_reason)] += 1;
+		)
+
+		m_verticesTracker = 0;
+		m_indicesTracker = 0;
+	}
+
+	void Render::submit(const Renderer::CommandBuffer& _commandBuffer)
+	{
+		submit(&_commandBuffer, 1);
+	}
+
+	void Render::submit(const Renderer::CommandBuffer* _commandBuffers, size_t _count)
+	{
+		// merged in array order, so the result does not depend on which thread finished first
+		for(size_t i=0;i<_count;++i)
+			m_commandBuffer.append(_commandBuffers[i]);
+
+		// deferred renders draw them with everything else in render()
+		if(m_deferred)
+			return;
+
+		Renderer::Shader* bound_shader = Renderer::Shader::getCurrentShader();
+		replayCommands();
+		if(bound_shader)
+			bindShader(bound_shader);
+	}
+
+	void Render::drawStatic(Renderer::StaticBatch& _batch, const Renderer::Mat4<float>* _transform)
+	{
+		// everything drawn before the static batch stays below it
+		flush(FlushReason::STATIC_BATCH);
+		bool deferred = m_deferred;
+		m_deferred = false;
+
+		if(_batch.isDirty())
+			_batch.build(m_defaultShader, m_whiteTexture, m_textureSlotCount, m_window->getState());
+
+		BlendMode blend_mode = m_blendMode;
+		for(const StaticSegment& segment : _batch.getSegments())
+		{
+			bindShader(segment.shader);
+			for(unsigned int i=0;i<segment.textureCount;++i)
+				bindTexture(segment.textures[i], i);
+
+			if(segment.blendMode != m_blendMode)
+				setBlendMode(segment.blendMode);
+
+			// only the default shader knows about the transform
+			if(_transform && segment.shader == m_defaultShader)
+				m_defaultShader->setUniformMat4(m_defaultTransform, **_transform);
+
+			segment.shader->bindStreamBuffer(_batch.getVertexBuffer(), _batch.getIndexBuffer());
+			setRestartIndex(_batch.getIndexType());
+			glDrawElementsBaseVertex(segment.drawType, segment.indexCount, _batch.getIndexType(),
+					(const void*)(uintptr_t)segment.indexOffset, segment.baseVertex);
+
+			if(_transform && segment.shader == m_defaultShader)
+				m_defaultShader->setUniformMat4(m_defaultTransform, *Renderer::Mat4<float>());
+
+			RENDERER_STAT(
+				m_stats.drawCalls += 1;
+				m_stats.indices += segment.indexCount;
+				m_stats.flushes[static_cast<int>(FlushReason::STATIC_BATCH)] += 1;
+			)
+		}
+
+		if(m_blendMode != blend_mode)
+			setBlendMode(blend_mode);
+		m_deferred = deferred;
+	}
+
+	void Render::replayCommands()
+	{
+		if(m_commandBuffer.empty())
+			return;
+
+		m_commandBuffer.sort();
+
+		// the recorded commands are batched like any immediate draw
+		bool deferred = m_deferred;
+		m_deferred = false;
+		BlendMode record_blend_mode = m_blendMode;
+		Renderer::Shader* record_shader = m_recordShader;
+		Renderer::Texture* record_texture = m_recordTexture;
+
+		std::vector<unsigned int> sprite_run;
+		const std::vector<DrawCommand>& commands = m_commandBuffer.getCommands();
+		for(unsigned int i=0;i<commands.size();++i)
+		{
+			const DrawCommand& command = commands[i];
+			if(command.blendMode != m_blendMode)
+				setBlendMode(command.blendMode);
+
+			// neighbouring sprites go through drawSprites() together
+			if(command.type == CommandType::SPRITE)
+			{
+				sprite_run.push_back(command.index);
+				if(i + 1 < commands.size() && commands[i + 1].type == CommandType::SPRITE
+						&& commands[i + 1].blendMode == command.blendMode)
+					continue;
+
+				drawRecordedSprites(sprite_run.data(), sprite_run.size());
+				sprite_run.clear();
+				continue;
+			}
+
+			const ShapeCommand& shape = m_commandBuffer.getShape(command.index);
+			bindShader(shape.shader);
+			bindTexture(shape.texture, 0);
+
+			beginShape(shape.type, shape.vertexCount, shape.customIndices ? shape.indexCount : 0);
+			memcpy(m_shapeWrite, m_commandBuffer.getVertices(shape.vertexOffset), shape.vertexCount * m_shapeVertexSize);
+			m_shapeVertexTracker = 1;
+			m_shapeVertexBytesLeft = 0;
+
+			if(shape.customIndices)
+				endShape(m_commandBuffer.getIndices(shape.indexOffset));
+			else
+				endShape();
+		}
+
+		m_commandBuffer.clear();
+
+		// drawing continues with the state the user last set
+		if(m_blendMode != record_blend_mode)
+			setBlendMode(record_blend_mode);
+		m_deferred = deferred;
+		m_recordShader = record_shader;
+		m_recordTexture = record_texture;
+	}
+
+	void Render::reserveQuadIndices(unsigned int _quadCount)
+	{
+		if(_quadCount <= m_quadIndexCapacity)
+			return;
+
+		// every quad uses the same 0, 1, 2, 0, 2, 3 pattern offset by its first vertex
+		unsigned int quad_capacity = m_quadIndexCapacity * 2 > _quadCount ? m_quadIndexCapacity * 2 : _quadCount;
+		std::vector<unsigned int> quad_indices(6 * quad_capacity);
+		for(unsigned int i=0;i<quad_capacity;++i)
+		{
+			quad_indices[6 * i    ] = 4 * i;
+			quad_indices[6 * i + 1] = 4 * i + 1;
+			quad_indices[6 * i + 2] = 4 * i + 2;
+			quad_indices[6 * i + 3] = 4 * i;
+			quad_indices[6 * i + 4] = 4 * i + 2;
+			quad_indices[6 * i + 5] = 4 * i + 3;
+		}
+
+		// upload through the array target so the bound vao keeps its element buffer
+		if(m_quadIndexBuffer == 0)
+			glGenBuffers(1, &m_quadIndexBuffer);
+
+		m_window->getState().bindArrayBuffer(m_quadIndexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(unsigned int) * quad_indices.size(), quad_indices.data(), GL_STATIC_DRAW);
+		RENDERER_STAT(m_stats.bytesUploaded += sizeof(unsigned int) * quad_indices.size());
+
+		m_quadIndexCapacity = quad_capacity;
+	}
+
+	unsigned int Render::streamBufferSize(unsigned int _vertexBatchSize, unsigned int _indexBatchSize,
+			unsigned int _streamBufferSize)
+	{
+		// the stream buffer has to fit at least one full batch plus its alignment padding
+		unsigned int batch_size = _vertexBatchSize + sizeof(unsigned int) * _indexBatchSize + 256;
+		if(_streamBufferSize < batch_size)
+			return batch_size;
+
+		return _streamBufferSize;
+	}
+
+	void Render::assertShapeComplete()
+	{
+		if(m_shapeVertexTracker > 1)
+			throw Renderer::RenderingException("Too few vertices are passed in! Please call beginShape() with the correct number of vertices!");
+		if(m_shapeVertexTracker < 1)
+			throw Renderer::RenderingException("Too many vertices are passed in! Please call beginShape() with the correct number of vertices!");
+
+		if(m_shapeVertexBytesLeft > 0)
+			throw Renderer::RenderingException("Not enough bytes are passed in for the last vertex!");
+	}
+
 	void Render::assertShapeVertexSafeToStore(unsigned int _bytesRequired)
 	{
 		if(m_shapeVertexBytesLeft < _bytesRequired)
@@ -506,17 +1424,21 @@ namespace Renderer
 		delete[] m_verticesBatch;
 		delete[] m_indicesBatch;
 		delete m_defaultShader;
+		delete m_instanceShader;
 		delete m_whiteTexture;
+
+		if(m_quadIndexBuffer != 0)
+		{
+			glDeleteBuffers(1, &m_quadIndexBuffer);
+			m_window->getState().bufferDeleted(m_quadIndexBuffer);
+		}
 	}
 
 	void RendererWindowEvent::WindowResize(int _width, int _height)
 	{
 		m_renderer->getWindow()->makeCurrent();
 
-		Renderer::Mat4<float> projection = Renderer::Math::projection2D(
-				0.f, static_cast<float>(_width),
-				0.f, static_cast<float>(_height),
-				1.f, -1.f);
-		m_renderer->m_defaultShader->setUniformMatrix("u_projection", *projection);
+		// one upload for every shader reading the frame block
+		m_renderer->updateFrameBlock(static_cast<float>(_width), static_cast<float>(_height));
 	}
 }
@@ -0,0 +1,203 @@
+#include "Sprite.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RENDERER_SPRITE_SSE
+#endif
+
+namespace Renderer
+{
+	Sprite rectSprite(Renderer::Texture* _texture, int _x, int _y, int _width, int _height, const RectStyle& _style)
+	{
+		// calculate the alignment
+		float vertical_align = _style.verticalAlignAmount;
+		float horizontal_align = _style.horizontalAlignAmount;
+		switch(_style.verticalAlign)
+		{
+			case VerticalAlign::TOP:
+				vertical_align = 0;
+				break;
+			case VerticalAlign::CENTER:
+				vertical_align = _height / 2;
+				break;
+			case VerticalAlign::BOTTOM:
+				vertical_align = _height;
+				break;
+			default:
+				break;
+		}
+
+		switch(_style.horizontalAlign)
+		{
+			case HorizontalAlign::LEFT:
+				horizontal_align = 0;
+				break;
+			case HorizontalAlign::CENTER:
+				horizontal_align = _width / 2;
+				break;
+			case HorizontalAlign::RIGHT:
+				horizontal_align = _width;
+				break;
+			default:
+				break;
+		}
+
+		return {
+			_texture,
+			static_cast<float>(_x), static_cast<float>(_y),
+			static_cast<float>(_width), static_cast<float>(_height),
+			_style.angle,
+			horizontal_align, vertical_align,
+			_style.color,
+			0.f, 0.f, 1.f, 1.f
+		};
+	}
+
+	bool spriteVisible(const Sprite& _sprite, float _width, float _height)
+	{
+		float sin_ang = 0.f;
+		float cos_ang = 1.f;
+		if(_sprite.angle != 0.f)
+			Renderer::Math::FastSinCos(_sprite.angle, sin_ang, cos_ang);
+
+		return spriteVisible(_sprite, sin_ang, cos_ang, _width, _height);
+	}
+
+	bool spriteVisible(const Sprite& _sprite, float _sin, float _cos, float _width, float _height)
+	{
+		// unrotated sprites are their own bounding box
+		if(_sprite.angle == 0.f)
+		{
+			float left = _sprite.x - _sprite.alignX;
+			float top = _sprite.y - _sprite.alignY;
+			return left + _sprite.width >= 0.f && left <= _width && top + _sprite.height >= 0.f && top <= _height;
+		}
+
+		// the center of the sprite rotated around (x, y), the box is grown to fit the rotated corners
+		float center_x = _sprite.width / 2 - _sprite.alignX;
+		float center_y = _sprite.height / 2 - _sprite.alignY;
+		float world_x = _cos * center_x - _sin * center_y + _sprite.x;
+		float world_y = _sin * center_x + _cos * center_y + _sprite.y;
+
+		float extent_x = (std::abs(_cos) * _sprite.width + std::abs(_sin) * _sprite.height) / 2;
+		float extent_y = (std::abs(_sin) * _sprite.width + std::abs(_cos) * _sprite.height) / 2;
+
+		return world_x + extent_x >= 0.f && world_x - extent_x <= _width
+			&& world_y + extent_y >= 0.f && world_y - extent_y <= _height;
+	}
+
+	void spriteCorners(const Sprite& _sprite, float _sin, float _cos, float* _positions)
+	{
+		float left = -_sprite.alignX;
+		float top = -_sprite.alignY;
+
+		// no rotation, no multiply
+		if(_sprite.angle == 0.f)
+		{
+			left += _sprite.x;
+			top += _sprite.y;
+			float right = left + _sprite.width;
+			float bottom = top + _sprite.height;
+
+			_positions[0] = left;
+			_positions[1] = top;
+			_positions[2] = left;
+			_positions[3] = bottom;
+			_positions[4] = right;
+			_positions[5] = bottom;
+			_positions[6] = right;
+			_positions[7] = top;
+			return;
+		}
+
+#ifdef RENDERER_SPRITE_SSE
+		// the 4 corners side by side
+		__m128 corner_x = _mm_add_ps(_mm_set1_ps(left), _mm_set_ps(_sprite.width, _sprite.width, 0.f, 0.f));
+		__m128 corner_y = _mm_add_ps(_mm_set1_ps(top), _mm_set_ps(0.f, _sprite.height, _sprite.height, 0.f));
+
+		__m128 cos_vec = _mm_set1_ps(_cos);
+		__m128 sin_vec = _mm_set1_ps(_sin);
+		__m128 pos_x = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(cos_vec, corner_x), _mm_mul_ps(sin_vec, corner_y)),
+				_mm_set1_ps(_sprite.x));
+		__m128 pos_y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(sin_vec, corner_x), _mm_mul_ps(cos_vec, corner_y)),
+				_mm_set1_ps(_sprite.y));
+
+		_mm_storeu_ps(_positions, _mm_unpacklo_ps(pos_x, pos_y));
+		_mm_storeu_ps(_positions + 4, _mm_unpackhi_ps(pos_x, pos_y));
+#else
+		float corner_x[] = { left, left, left + _sprite.width, left + _sprite.width };
+		float corner_y[] = { top, top + _sprite.height, top + _sprite.height, top };
+		for(int j=0;j<4;++j)
+		{
+			_positions[j * 2] = _cos * corner_x[j] - _sin * corner_y[j] + _sprite.x;
+			_positions[j * 2 + 1] = _sin * corner_x[j] + _cos * corner_y[j] + _sprite.y;
+		}
+#endif
+	}
+
+	// the 4 vertices of a sprite with its corners already placed
+	static inline void writeSpriteVertices(const Sprite& _sprite, const float* _positions, int _textureSlot, DefaultVertex* _vertices)
+	{
+		// the color and texture region are the same for all 4 corners
+		uint8_t red = Pack::channel(_sprite.color.red);
+		uint8_t green = Pack::channel(_sprite.color.green);
+		uint8_t blue = Pack::channel(_sprite.color.blue);
+		uint8_t alpha = Pack::channel(_sprite.color.alpha);
+		uint16_t u0 = Pack::unorm16(_sprite.u0);
+		uint16_t v0 = Pack::unorm16(_sprite.v0);
+		uint16_t u1 = Pack::unorm16(_sprite.u1);
+		uint16_t v1 = Pack::unorm16(_sprite.v1);
+		int16_t slot = static_cast<int16_t>(_textureSlot);
+
+		_vertices[0] = { _positions[0], _positions[1], red, green, blue, alpha, u0, v1, slot, 0 };
+		_vertices[1] = { _positions[2], _positions[3], red, green, blue, alpha, u0, v0, slot, 0 };
+		_vertices[2] = { _positions[4], _positions[5], red, green, blue, alpha, u1, v0, slot, 0 };
+		_vertices[3] = { _positions[6], _positions[7], red, green, blue, alpha, u1, v1, slot, 0 };
+	}
+
+	void spriteVertices(const Sprite* _sprites, size_t _count, int _textureSlot, DefaultVertex* _vertices)
+	{
+		// sprites of one call tend to share their angle, the approximation is only redone when it changes
+		float last_angle = 0.f;
+		float sin_ang = 0.f;
+		float cos_ang = 1.f;
+
+		for(size_t i=0;i<_count;++i)
+		{
+			const Sprite& sprite = _sprites[i];
+			if(sprite.angle != last_angle)
+			{
+				Renderer::Math::FastSinCos(sprite.angle, sin_ang, cos_ang);
+				last_angle = sprite.angle;
+			}
+
+			float positions[8];
+			spriteCorners(sprite, sin_ang, cos_ang, positions);
+			writeSpriteVertices(sprite, positions, _textureSlot, _vertices + i * 4);
+		}
+	}
+
+	void spriteInstances(const Sprite* _sprites, size_t _count, int _textureSlot, SpriteInstance* _instances)
+	{
+		for(size_t i=0;i<_count;++i)
+		{
+			const Sprite& sprite = _sprites[i];
+			SpriteInstance& instance = _instances[i];
+
+			instance.x = sprite.x;
+			instance.y = sprite.y;
+			instance.width = sprite.width;
+			instance.height = sprite.height;
+			instance.alignX = sprite.alignX;
+			instance.alignY = sprite.alignY;
+			instance.angle = sprite.angle;
+			instance.u0 = sprite.u0;
+			instance.v0 = sprite.v0;
+			instance.u1 = sprite.u1;
+			instance.v1 = sprite.v1;
+			instance.color = Pack::channel(sprite.color.red) | Pack::channel(sprite.color.green) << 8
+				| Pack::channel(sprite.color.blue) << 16 | static_cast<unsigned int>(Pack::channel(sprite.color.alpha)) << 24;
+			instance.textureSlot = _textureSlot;
+		}
+	}
+}
@@ -0,0 +1,224 @@
+#include "StaticBatch.hpp"
+
+namespace Renderer
+{
+	StaticBatch::StaticBatch()
+		: m_state(nullptr), m_vbo(0), m_ibo(0), m_indexType(GL_UNSIGNED_INT), m_dirty(true)
+	{
+	}
+
+	void StaticBatch::clear()
+	{
+		m_commands.clear();
+		m_dirty = true;
+	}
+
+	void StaticBatch::build(Renderer::Shader* _defaultShader, Renderer::Texture* _whiteTexture, unsigned int _textureSlotCount,
+			Renderer::GLState& _state)
+	{
+		m_state = &_state;
+
+		if(_textureSlotCount > StaticSegment::MAX_TEXTURES)
+			_textureSlotCount = StaticSegment::MAX_TEXTURES;
+
+		m_commands.sort();
+		m_segments.clear();
+
+		std::vector<unsigned char> vertices;
+		std::vector<unsigned int> indices;
+
+		bool segment_open = false;
+		unsigned int segment_vertex_count = 0;
+		unsigned int max_segment_vertices = 0;
+
+		const std::vector<DrawCommand>& commands = m_commands.getCommands();
+		for(const DrawCommand& command : commands)
+		{
+			Renderer::Shader* shader = _defaultShader;
+			Renderer::Texture* texture = nullptr;
+			DrawType type = DrawType::QUAD;
+			const ShapeCommand* shape = nullptr;
+			if(command.type == CommandType::SPRITE)
+				texture = m_commands.getSprite(command.index).texture;
+			else
+			{
+				shape = &m_commands.getShape(command.index);
+				shader = shape->shader ? shape->shader : _defaultShader;
+				texture = shape->texture;
+				type = shape->type;
+			}
+			if(!texture)
+				texture = _whiteTexture;
+
+			GLenum draw_type = glDrawType(type);
+			unsigned int vertex_size = shader->getVertexBitSize();
+
+			// sprites can take any free texture slot, shapes sample from slot 0
+			bool fits = false;
+			unsigned int texture_slot = 0;
+			if(segment_open)
+			{
+				StaticSegment& segment = m_segments.back();
+				fits = segment.shader == shader && segment.blendMode == command.blendMode && segment.drawType == draw_type;
+
+				if(fits && shape)
+					fits = segment.textures[0] == texture;
+				else if(fits)
+				{
+					for(texture_slot=0;texture_slot<segment.textureCount;++texture_slot)
+						if(segment.textures[texture_slot] == texture)
+							break;
+
+					if(texture_slot == segment.textureCount && segment.textureCount >= _textureSlotCount)
+						fits = false;
+				}
+			}
+
+			if(!fits)
+			{
+				// the first vertex has to be a whole vertex into the buffer for the base vertex
+				vertices.resize((vertices.size() + vertex_size - 1) / vertex_size * vertex_size);
+
+				StaticSegment segment;
+				segment.shader = shader;
+				segment.textures[0] = texture;
+				segment.textureCount = 1;
+				segment.blendMode = command.blendMode;
+				segment.drawType = draw_type;
+				segment.indexOffset = indices.size();
+				segment.indexCount = 0;
+				segment.baseVertex = vertices.size() / vertex_size;
+				m_segments.push_back(segment);
+
+				segment_open = true;
+				segment_vertex_count = 0;
+				texture_slot = 0;
+			}
+
+			StaticSegment& segment = m_segments.back();
+			if(texture_slot == segment.textureCount)
+				segment.textures[segment.textureCount ++] = texture;
+
+			unsigned int first_vertex = segment_vertex_count;
+			unsigned int first_index = indices.size();
+
+			// strips, fans and loops sharing the draw call are split by the restart index
+			if(isStripType(type) && segment.indexCount > 0)
+				indices.push_back(PRIMITIVE_RESTART_INDEX);
+
+			if(!shape)
+			{
+				unsigned int vertex_offset = vertices.size();
+				vertices.resize(vertex_offset + 4 * vertex_size);
+				Renderer::spriteVertices(&m_commands.getSprite(command.index), 1, static_cast<int>(texture_slot),
+						reinterpret_cast<Renderer::DefaultVertex*>(vertices.data() + vertex_offset));
+
+				indices.insert(indices.end(), {
+					first_vertex, first_vertex + 1, first_vertex + 2,
+					first_vertex, first_vertex + 2, first_vertex + 3
+				});
+				segment_vertex_count += 4;
+			} else
+			{
+				const unsigned char* shape_vertices = m_commands.getVertices(shape->vertexOffset);
+				vertices.insert(vertices.end(), shape_vertices, shape_vertices + shape->vertexCount * vertex_size);
+
+				// the same indices Render::endShape() would make
+				if(shape->customIndices)
+				{
+					const unsigned int* shape_indices = m_commands.getIndices(shape->indexOffset);
+					for(unsigned int i=0;i<shape->indexCount;++i)
+					{
+						if(shape_indices[i] == PRIMITIVE_RESTART_INDEX)
+							indices.push_back(PRIMITIVE_RESTART_INDEX);
+						else
+							indices.push_back(first_vertex + shape_indices[i]);
+					}
+				} else if(type == DrawType::QUAD)
+				{
+					for(unsigned int i=0;i<shape->vertexCount / 4;++i)
+					{
+						unsigned int quad_vertex = first_vertex + 4 * i;
+						indices.insert(indices.end(), {
+							quad_vertex, quad_vertex + 1, quad_vertex + 2,
+							quad_vertex, quad_vertex + 2, quad_vertex + 3
+						});
+					}
+				} else if(type == DrawType::TRIANGLE)
+				{
+					for(unsigned int i=0;i+2<shape->vertexCount;++i)
+						indices.insert(indices.end(), { first_vertex, first_vertex + 1 + i, first_vertex + 2 + i });
+				} else
+				{
+					for(unsigned int i=0;i<shape->vertexCount;++i)
+						indices.push_back(first_vertex + i);
+				}
+				segment_vertex_count += shape->vertexCount;
+			}
+
+			segment.indexCount += indices.size() - first_index;
+			if(segment_vertex_count > max_segment_vertices)
+				max_segment_vertices = segment_vertex_count;
+		}
+
+		// the indices are relative to their segment, 16 bits do unless a segment reaches 65535 vertices
+		m_indexType = max_segment_vertices < 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+		unsigned int index_size = m_indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+		for(StaticSegment& segment : m_segments)
+			segment.indexOffset *= index_size;
+
+		// upload through the array target so the bound vao keeps its element buffer
+		if(m_vbo == 0)
+			glGenBuffers(1, &m_vbo);
+		if(m_ibo == 0)
+			glGenBuffers(1, &m_ibo);
+
+		m_state->bindArrayBuffer(m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+		m_state->bindArrayBuffer(m_ibo);
+		if(m_indexType == GL_UNSIGNED_SHORT)
+		{
+			// the restart index truncates to 0xFFFF
+			std::vector<uint16_t> short_indices(indices.begin(), indices.end());
+			glBufferData(GL_ARRAY_BUFFER, sizeof(uint16_t) * short_indices.size(), short_indices.data(), GL_STATIC_DRAW);
+		} else
+			glBufferData(GL_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(), GL_STATIC_DRAW);
+
+		m_dirty = false;
+	}
+
+	GLenum StaticBatch::glDrawType(DrawType _type)
+	{
+		switch(_type)
+		{
+			case DrawType::POINTS:
+				return GL_POINTS;
+			case DrawType::TRIANGLE_STRIP:
+				return GL_TRIANGLE_STRIP;
+			case DrawType::TRIANGLE_FAN:
+				return GL_TRIANGLE_FAN;
+			case DrawType::LINE:
+				return GL_LINES;
+			case DrawType::LINE_STRIP:
+				return GL_LINE_STRIP;
+			case DrawType::LINE_LOOP:
+				return GL_LINE_LOOP;
+			default:
+				return GL_TRIANGLES;
+		}
+	}
+
+	StaticBatch::~StaticBatch()
+	{
+		if(m_vbo != 0)
+		{
+			glDeleteBuffers(1, &m_vbo);
+			m_state->bufferDeleted(m_vbo);
+		}
+		if(m_ibo != 0)
+		{
+			glDeleteBuffers(1, &m_ibo);
+			m_state->bufferDeleted(m_ibo);
+		}
+	}
+}
@@ -1,5 +1,13 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+
 #include <Renderer.hpp>
 
+#define SPRITE_COUNT 10000
+#define THREAD_COUNT 4
+
 int main()
 {
 	Renderer::Window::GLFWInit();
@@ -10,15 +18,112 @@ int main()
 	renderer.attach(&window);
 	renderer.init();
 
+	std::vector<Renderer::Sprite> sprites(SPRITE_COUNT);
+	for(int i=0;i<SPRITE_COUNT;++i)
+	{
+		sprites[i] = {
+			nullptr,
+			static_cast<float>(i % 100) * 8.f, static_cast<float>(i / 100) * 6.f,
+			6.f, 4.f,
+			0.f,
+			3.f, 2.f,
+			Renderer::Color(i % 256, 100, 255 - i % 256, 255),
+			0.f, 0.f, 1.f, 1.f
+		};
+	}
+
+	// each worker thread records its share of the sprites into its own command buffer
+	std::vector<Renderer::CommandBuffer> command_buffers(THREAD_COUNT);
+
+	// a background that is uploaded once and only moved by its transform
+	Renderer::StaticBatch background;
+	Renderer::RectStyle background_style = renderer.getStyle();
+	for(int i=0;i<SPRITE_COUNT;++i)
+	{
+		background_style.color = Renderer::Color(40, 40, 40 + i % 64, 255);
+		background.getCommandBuffer().drawRect((i % 100) * 8, (i / 100) * 6, 7, 5, background_style);
+	}
+	Renderer::Mat4<float> background_transform;
+
+	int frame = 0;
 	while(window.isOpened())
 	{
 		glClear(GL_COLOR_BUFFER_BIT);
 
+		background_transform.set(0, 3, static_cast<float>(frame % 120) * 0.5f);
+		renderer.drawStatic(background, &background_transform);
+
+		// alternate between 4 vertices and one instance per sprite every 120 frames
+		renderer.setInstancing((frame / 120) % 2 == 1);
+
 		renderer.setColor(Renderer::Color(255, 0, 255, 255));
 		renderer.drawRect(100, 100, 100, 100);
 		renderer.drawRect(200, 200, 100, 100);
 
+		// the same sprites through the per call path and the bulk path
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for(const Renderer::Sprite& sprite : sprites)
+		{
+			Renderer::RectStyle style = renderer.getStyle();
+			style.color = sprite.color;
+			style.angle = sprite.angle;
+			style.horizontalAlignAmount = sprite.alignX;
+			style.verticalAlignAmount = sprite.alignY;
+			renderer.drawRect(sprite.x, sprite.y, sprite.width, sprite.height, style);
+		}
+		std::chrono::high_resolution_clock::time_point per_call_end = std::chrono::high_resolution_clock::now();
+		renderer.drawSprites(sprites.data(), sprites.size());
+		std::chrono::high_resolution_clock::time_point bulk_end = std::chrono::high_resolution_clock::now();
+
+		std::vector<std::thread> workers;
+		for(int i=0;i<THREAD_COUNT;++i)
+		{
+			workers.emplace_back([&, i]() {
+				Renderer::RectStyle style = renderer.getStyle();
+				command_buffers[i].clear();
+				for(int j=i;j<SPRITE_COUNT;j+=THREAD_COUNT)
+				{
+					style.color = sprites[j].color;
+					command_buffers[i].drawRect(sprites[j].x + 2, sprites[j].y + 2, sprites[j].width, sprites[j].height, style);
+				}
+			});
+		}
+		for(std::thread& worker : workers)
+			worker.join();
+
+		renderer.submit(command_buffers.data(), command_buffers.size());
+		std::chrono::high_resolution_clock::time_point submit_end = std::chrono::high_resolution_clock::now();
+
 		renderer.render();
+
+		if(++frame % 120 == 0)
+		{
+			double per_call = std::chrono::duration<double>(per_call_end - start).count();
+			double bulk = std::chrono::duration<double>(bulk_end - per_call_end).count();
+			std::cout << (renderer.isInstancing() ? "instanced " : "vertices  ");
+			std::cout << "per call: " << SPRITE_COUNT / per_call << " sprites/s, ";
+			double threaded = std::chrono::duration<double>(submit_end - bulk_end).count();
+			std::cout << "drawSprites: " << SPRITE_COUNT / bulk << " sprites/s, ";
+			std::cout << THREAD_COUNT << " threads: " << SPRITE_COUNT / threaded << " sprites/s" << std::endl;
+
+			const Renderer::RenderStats& stats = renderer.getStats();
+			std::cout << "\t" << stats.drawCalls << " draws, " << stats.vertices << " vertices, ";
+			std::cout << stats.indices << " indices, " << stats.bytesUploaded << " bytes uploaded, ";
+			std::cout << stats.culled << " culled" << std::endl;
+			for(int i=0;i<static_cast<int>(Renderer::FlushReason::COUNT);++i)
+			{
+				if(stats.flushes[i] > 0)
+					std::cout << "\t\t" << Renderer::flushReasonName(static_cast<Renderer::FlushReason>(i)) << ": " << stats.flushes[i] << std::endl;
+			}
+
+			Renderer::BatchSizing sizing = renderer.getBatchSizing();
+			std::cout << "\tbatches: " << sizing.vertexBatchSize << " vertex bytes, " << sizing.indexBatchSize << " indices, ";
+			std::cout << sizing.streamBufferSize << " stream bytes, " << sizing.overflows << " overflows" << std::endl;
+			std::cout << "\t" << renderer.getStateCache().getSkippedCalls() << " redundant gl calls skipped, ";
+			std::cout << renderer.getStateCache().getIssuedCalls() << " issued" << std::endl;
+		}
+		renderer.resetStats();
+
 		window.swapBuffers();
 		Renderer::Window::pollEvents();
 	}
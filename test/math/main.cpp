@@ -591,6 +591,35 @@ void TestHelperFunctions()
 	assert(std::abs(lerp_float_result - 2.3) < TOLERANCE);
 
 	PASSED("Lerp() on vectors and floats");
+
+	// test the approximate sin and cos against the standard library, both signs and every quadrant
+	for(int i=-2000;i<=2000;++i)
+	{
+		float angle = i * 0.0137f;
+		float fast_sin, fast_cos;
+		Renderer::Math::FastSinCos(angle, fast_sin, fast_cos);
+
+		assert(std::abs(fast_sin - std::sin(angle)) < 1e-6);
+		assert(std::abs(fast_cos - std::cos(angle)) < 1e-6);
+	}
+
+	PASSED("FastSinCos()");
+
+	// test the angle cache with a new, the same and another angle
+	Renderer::Math::AngleCache angle_cache;
+	float cache_sin, cache_cos;
+	angle_cache.sinCos(0.f, cache_sin, cache_cos);
+	assert(cache_sin == 0.f && cache_cos == 1.f);
+
+	angle_cache.sinCos(1.2f, cache_sin, cache_cos);
+	assert(cache_sin == std::sin(1.2f) && cache_cos == std::cos(1.2f));
+	angle_cache.sinCos(1.2f, cache_sin, cache_cos);
+	assert(cache_sin == std::sin(1.2f) && cache_cos == std::cos(1.2f));
+
+	angle_cache.sinCos(-2.5f, cache_sin, cache_cos);
+	assert(cache_sin == std::sin(-2.5f) && cache_cos == std::cos(-2.5f));
+
+	PASSED("AngleCache");
 }
 
 void TestVec4Float()
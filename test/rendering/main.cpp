@@ -9,7 +9,12 @@ const char* vertex_shader = R"(
 #version 410 core
 layout (location = 0) in vec2 a_position;
 
-uniform mat4 u_projection;
+layout(std140) uniform RendererFrame
+{
+	mat4 u_projection;
+	vec2 u_viewport;
+	float u_time;
+};
 
 void main()
 {
@@ -43,9 +48,7 @@ int main()
 	test_shader.create(vertex_shader, fragment_shader);
 	test_shader.vertexAttribAdd(0, Renderer::AttribType::VEC2);
 	test_shader.vertexAttribsEnable();
-	test_shader.uniformAdd("u_projection", Renderer::UniformType::MAT4);
-	Renderer::Mat4<float> projection = Renderer::Math::projection2D(0.f, 800.f, 0.f, 600.f, 1.f, -1.f);
-	test_shader.setUniformMatrix("u_projection", *projection);
+	renderer.bindFrameBlock(test_shader);
 
 	Renderer::Window window2;
 	window2.init(800, 600, "Second Window");
@@ -77,6 +80,35 @@ int main()
 		renderer.vertex2f(100.f, 200.f);
 		renderer.endShape();
 
+		// two quads in one shape join the pending triangle batch
+		renderer.beginShape(Renderer::DrawType::QUAD, 8, 0);
+		for(int i=0;i<2;++i)
+		{
+			float x = 250.f + i * 120.f;
+			renderer.vertex2f(x, 400.f);
+			renderer.nextVertex();
+			renderer.vertex2f(x + 100.f, 400.f);
+			renderer.nextVertex();
+			renderer.vertex2f(x + 100.f, 500.f);
+			renderer.nextVertex();
+			renderer.vertex2f(x, 500.f);
+			if(i == 0)
+				renderer.nextVertex();
+		}
+		renderer.endShape();
+
+		// separate strips share one draw call through the restart index
+		for(int i=0;i<4;++i)
+		{
+			renderer.beginShape(Renderer::DrawType::LINE_STRIP, 3, 0);
+			renderer.vertex2f(500.f, 100.f + i * 40.f);
+			renderer.nextVertex();
+			renderer.vertex2f(550.f, 130.f + i * 40.f);
+			renderer.nextVertex();
+			renderer.vertex2f(600.f, 100.f + i * 40.f);
+			renderer.endShape();
+		}
+
 		renderer.setColor(Renderer::Color(255, 255, 255, 150));
 		renderer.drawRect(150, 150, 200, 200);
 
@@ -92,16 +124,27 @@ int main()
 
 		renderer2.beginShape(Renderer::DrawType::TRIANGLE, 3, 0);
 		renderer2.vertex2f(300.f, 200.f);
-		renderer2.vertex4f(1.f, 1.f, 0.f, 1.f);
-		renderer2.vertex2f(0.f, 0.f);
+		renderer2.vertex4ub(255, 255, 0, 255);
+		renderer2.vertex2unorm(0.f, 0.f);
+		renderer2.vertex2s(0, 0);
 		renderer2.nextVertex();
 		renderer2.vertex2f(400.f, 300.f);
-		renderer2.vertex4f(1.f, 1.f, 0.f, 1.f);
-		renderer2.vertex2f(0.f, 1.f);
+		renderer2.vertex4ub(255, 255, 0, 255);
+		renderer2.vertex2unorm(0.f, 1.f);
+		renderer2.vertex2s(0, 0);
 		renderer2.nextVertex();
 		renderer2.vertex2f(400.f, 400.f);
-		renderer2.vertex4f(1.f, 1.f, 0.f, 1.f);
-		renderer2.vertex2f(1.f, 0.f);
+		renderer2.vertex4ub(255, 255, 0, 255);
+		renderer2.vertex2unorm(1.f, 0.f);
+		renderer2.vertex2s(0, 0);
+		renderer2.endShape();
+
+		// the same triangle through the typed writer
+		Renderer::VertexWriter<Renderer::DefaultVertex> writer =
+			renderer2.beginShape<Renderer::DefaultVertex>(Renderer::DrawType::TRIANGLE, 3);
+		writer.vertex({ 500.f, 200.f, 255, 255, 0, 255, 0, 0, 0, 0 });
+		writer.vertex({ 600.f, 300.f, 255, 255, 0, 255, 0, 65535, 0, 0 });
+		writer.vertex({ 600.f, 400.f, 255, 255, 0, 255, 65535, 0, 0, 0 });
 		renderer2.endShape();
 
 		renderer2.setAngle(rotation_angle);
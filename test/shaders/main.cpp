@@ -4,6 +4,10 @@
 int main() {
 	Renderer::Window::GLFWInit();
 
+	// the second shader and any later run load the program instead of compiling it
+	Renderer::ProgramCache program_cache("./shader_cache");
+	Renderer::Shader::setProgramCache(&program_cache);
+
 	// initialize everything for window 1
 	Renderer::Window window;
 	window.init(800, 600, "Test Shaders");
@@ -11,6 +15,10 @@ int main() {
 	Renderer::Shader shader;
 	shader.attach(&window);
 	shader.createFromFile("./vertex.glsl", "./fragment.glsl", true);
+
+	// saving either file recompiles the shader of window 1
+	Renderer::ShaderWatcher shader_watcher;
+	shader_watcher.watch(shader, "./vertex.glsl", "./fragment.glsl");
 	shader.vertexAttribAdd(0, Renderer::AttribType::VEC3);
 	shader.vertexAttribAdd(1, Renderer::AttribType::VEC3);
 	shader.uniformAdd("u_projection", Renderer::UniformType::MAT4);
@@ -50,24 +58,31 @@ int main() {
 	Renderer::Shader shader2;
 	shader2.attach(&window2);
 	shader2.createFromFile("./vertex.glsl", "./fragment.glsl", true);
-	shader2.vertexAttribAdd(0, Renderer::AttribType::VEC3);
-	shader2.vertexAttribAdd(1, Renderer::AttribType::VEC3);
-	shader2.uniformAdd("u_projection", Renderer::UniformType::MAT4);
-	shader2.uniformAdd("u_sumVector", Renderer::UniformType::IVEC3);
+	// the layout and the uniforms are read from the program
+	Renderer::UniformHandle sum_vector_uniform2 = shader2.uniform("u_sumVector");
 	shader2.vertexAttribsEnable();
 
 	shader2.verticesData(vertices, 18 * sizeof(float));
 	shader2.indicesData(indices, 3);
 
+	const Renderer::ProgramCacheStats& cache_stats = program_cache.getStats();
+	std::cout << "program cache: " << cache_stats.hits << " hits, " << cache_stats.misses << " misses, "
+		<< cache_stats.loadSeconds * 1000.0 << "ms loading, " << cache_stats.compileSeconds * 1000.0 << "ms compiling" << std::endl;
+
 	Renderer::Mat4<float> projection2;
 	shader2.setUniformMatrix("u_projection", *projection2);
 
 	Renderer::Vec3<int> sum_vector2(0, 0, 0);
-	shader2.setUniformInt("u_sumVector", *sum_vector2);
+	shader2.setUniformIvec3(sum_vector_uniform2, *sum_vector2);
 
 	while(window2.isOpened())
 	{
 		window.makeCurrent();
+		unsigned int failures = shader_watcher.getFailureCount();
+		shader_watcher.update();
+		if(shader_watcher.getFailureCount() != failures)
+			std::cout << shader_watcher.getLastError() << std::endl;
+
 		//shader.bind();
 		glClearColor(0.0, 0.0, 0.0, 1.0);
 		glClear(GL_COLOR_BUFFER_BIT);